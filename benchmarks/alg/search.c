@@ -0,0 +1,131 @@
+#include "../benchmarks.h"
+
+#include <alg/search.h>
+#include <ds/btree.h>
+
+setup();
+
+#define LOOKUPS 1000000
+#define KEYS 1000000
+#define countof(a) (sizeof(a) / sizeof(*(a)))
+
+// Node sizes (2t - 1) for B-trees of degree 8, 32 and 128.
+size_t sizes[] = { 15, 63, 255 };
+
+int32_t* node;
+int32_t* lookups;
+
+// Keeps searches from being optimized away.
+volatile size_t sink;
+
+int
+main()
+{
+        char name[64];
+
+        start();
+
+        node = malloc(255 * sizeof(int32_t));
+        lookups = malloc(LOOKUPS * sizeof(int32_t));
+        for (int i = 0; i < 255; ++i)
+                node[i] = 2 * i;
+
+        for (size_t s = 0; s < countof(sizes); ++s)
+        {
+                size_t n = sizes[s];
+                for (int i = 0; i < LOOKUPS; ++i)
+                        lookups[i] = rand() % (2 * n + 1);
+
+                sprintf(name, "linear/n%zu", n);
+                benchmark_named(name, linear(n));
+                sprintf(name, "binary/n%zu", n);
+                benchmark_named(name, binary(n));
+                sprintf(name, "simd/n%zu", n);
+                benchmark_named(name, simd(n));
+        }
+
+        free(node);
+        free(lookups);
+
+        benchmark(btree_binary);
+        benchmark(btree_simd);
+
+        end();
+}
+
+int
+comparator(void* a, void* b)
+{
+        return (*(int32_t*)a > *(int32_t*)b) - (*(int32_t*)a < *(int32_t*)b);
+}
+
+int
+linear(size_t n)
+{
+        time_start();
+        for (int i = 0; i < LOOKUPS; ++i)
+                sink += search_linear(node, n, sizeof(int32_t), lookups + i,
+                                      comparator);
+        time_end();
+
+        return 0;
+}
+
+int
+binary(size_t n)
+{
+        time_start();
+        for (int i = 0; i < LOOKUPS; ++i)
+                sink += search_binary(node, n, sizeof(int32_t), lookups + i,
+                                      comparator);
+        time_end();
+
+        return 0;
+}
+
+int
+simd(size_t n)
+{
+        time_start();
+        for (int i = 0; i < LOOKUPS; ++i)
+                sink += search_i32(node, n, lookups[i]);
+        time_end();
+
+        return 0;
+}
+
+// Whole tree lookups on a B-tree with 1KiB blocks (t = 64 for int keys). The
+// only difference is the comparator, which picks the node search.
+int
+btree_lookups(int (*cmp)(void*, void*))
+{
+        int32_t* keys = malloc(KEYS * sizeof(int32_t));
+        struct btree* tree
+            = btree_create_block(sizeof(int32_t), sizeof(int32_t), 1024);
+        for (int i = 0; i < KEYS; ++i)
+        {
+                keys[i] = rand();
+                btree_insert(&tree, keys + i, keys + i, cmp);
+        }
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink += btree_search(tree, keys + i, cmp) != NULL;
+        time_end();
+
+        btree_destroy(tree);
+        free(keys);
+        return 0;
+}
+
+int
+btree_binary()
+{
+        return btree_lookups(comparator);
+}
+
+int
+btree_simd()
+{
+        return btree_lookups(search_cmp_i32);
+}
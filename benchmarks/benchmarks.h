@@ -1,44 +1,287 @@
 #pragma once
 
 #include <stdio.h>
-#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
-#include <perflib.h>
+#ifdef __linux__
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
-#define _RUNS 100
+// Timed runs per benchmark. Can be overridden at compile time with
+// -DBENCHMARK_RUNS=n or at run time with the BENCHMARK_RUNS variable.
+#ifndef BENCHMARK_RUNS
+#define BENCHMARK_RUNS 100
+#endif
 
+// Untimed runs executed before the timed ones, to warm up caches, the branch
+// predictor and the allocator. Overridable like BENCHMARK_RUNS.
+#ifndef BENCHMARK_WARMUP
+#define BENCHMARK_WARMUP 3
+#endif
+
+static inline long long
+_bench_now()
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline int
+_bench_env(const char* name, int fallback)
+{
+        const char* value = getenv(name);
+        return value ? atoi(value) : fallback;
+}
+
+// Orders int keys. Benchmarks draw them from rand(), which spans the whole int
+// range, so a - b would overflow.
+static inline int
+cmp_int(void* a, void* b)
+{
+        return (*(int*)a > *(int*)b) - (*(int*)a < *(int*)b);
+}
+
+// Hardware counters are opt-in through the BENCHMARK_COUNTERS variable. Each
+// counter is opened on its own so a PMU that lacks one event (or a hypervisor
+// that hides it) only drops that column. When perf events are not permitted at
+// all the benchmark runs exactly as if counters were never requested.
+#define _BENCH_COUNTERS 6
+
+#define _bench_cache(cache, op, result)                                       \
+        ((cache) | ((op) << 8) | ((result) << 16))
+
+struct _bench_counter
+{
+        const char* name;
+        unsigned type;
+        unsigned long long config;
+};
+
+#ifdef __linux__
+static const struct _bench_counter _bench_counter_defs[_BENCH_COUNTERS] = {
+        { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { "l1d_misses", PERF_TYPE_HW_CACHE,
+          _bench_cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                       PERF_COUNT_HW_CACHE_RESULT_MISS) },
+        { "llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { "dtlb_misses", PERF_TYPE_HW_CACHE,
+          _bench_cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                       PERF_COUNT_HW_CACHE_RESULT_MISS) },
+};
+#endif
+
+static int _bench_fd[_BENCH_COUNTERS];
+static long long* _bench_cs[_BENCH_COUNTERS];
+static int _bench_open;
+
+static void
+_bench_counters_open(int runs)
+{
+        _bench_open = 0;
+        for (int c = 0; c < _BENCH_COUNTERS; ++c)
+        {
+                _bench_fd[c] = -1;
+                _bench_cs[c] = NULL;
+        }
+
+        if (!_bench_env("BENCHMARK_COUNTERS", 0))
+                return;
+
+#ifdef __linux__
+        for (int c = 0; c < _BENCH_COUNTERS; ++c)
+        {
+                struct perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = _bench_counter_defs[c].type;
+                attr.config = _bench_counter_defs[c].config;
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+                                   | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                _bench_fd[c]
+                    = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+                if (_bench_fd[c] < 0)
+                {
+                        fprintf(stderr, "counter %s unavailable: %s\n",
+                                _bench_counter_defs[c].name, strerror(errno));
+                        continue;
+                }
+
+                _bench_cs[c] = calloc(runs, sizeof(long long));
+                ++_bench_open;
+        }
+
+        if (_bench_open == 0)
+        {
+                fprintf(stderr, "no counters available, check "
+                                "/proc/sys/kernel/perf_event_paranoid\n");
+                return;
+        }
+
+        // Name the columns so the chart script knows which counters made it.
+        printf("benchmark,ns");
+        for (int c = 0; c < _BENCH_COUNTERS; ++c)
+                if (_bench_fd[c] >= 0)
+                        printf(",%s", _bench_counter_defs[c].name);
+        printf("\n");
+#else
+        fprintf(stderr, "counters are only supported on linux\n");
+#endif
+}
+
+static void
+_bench_counters_close()
+{
+        for (int c = 0; c < _BENCH_COUNTERS; ++c)
+        {
+#ifdef __linux__
+                if (_bench_fd[c] >= 0)
+                        close(_bench_fd[c]);
+#endif
+                free(_bench_cs[c]);
+        }
+}
+
+static inline void
+_bench_counters_ctl(int request)
+{
+#ifdef __linux__
+        if (_bench_open == 0)
+                return;
+
+        for (int c = 0; c < _BENCH_COUNTERS; ++c)
+                if (_bench_fd[c] >= 0)
+                        ioctl(_bench_fd[c], request, 0);
+#endif
+}
+
+#ifdef __linux__
+#define _bench_counters_start()                                               \
+        _bench_counters_ctl(PERF_EVENT_IOC_RESET);                            \
+        _bench_counters_ctl(PERF_EVENT_IOC_ENABLE);
+#define _bench_counters_pause() _bench_counters_ctl(PERF_EVENT_IOC_DISABLE);
+#define _bench_counters_resume() _bench_counters_ctl(PERF_EVENT_IOC_ENABLE);
+#else
+#define _bench_counters_start()
+#define _bench_counters_pause()
+#define _bench_counters_resume()
+#endif
+
+static inline void
+_bench_counters_read(int run)
+{
+#ifdef __linux__
+        if (_bench_open == 0)
+                return;
+
+        _bench_counters_ctl(PERF_EVENT_IOC_DISABLE);
+        for (int c = 0; c < _BENCH_COUNTERS; ++c)
+        {
+                // value, time enabled, time running.
+                unsigned long long v[3];
+                if (_bench_fd[c] < 0 || read(_bench_fd[c], v, sizeof(v)) < 0)
+                        continue;
+
+                // Scale up if the kernel had to multiplex the counter.
+                if (v[2] && v[2] < v[1])
+                        v[0] = (double)v[0] * v[1] / v[2];
+                _bench_cs[c][run] = v[0];
+        }
+#endif
+}
+
+static void
+_bench_print(const char* name, long long* ts, int runs)
+{
+        printf("%s,%lld", name, ts[0]);
+        for (int i = 1; i < runs; ++i)
+                printf(";%lld", ts[i]);
+
+        for (int c = 0; c < _BENCH_COUNTERS; ++c)
+        {
+                if (_bench_cs[c] == NULL)
+                        continue;
+
+                printf(",%lld", _bench_cs[c][0]);
+                for (int i = 1; i < runs; ++i)
+                        printf(";%lld", _bench_cs[c][i]);
+        }
+        printf("\n");
+        fflush(stdout);
+}
+
+// Samples are nanoseconds. The CSV has one line per benchmark:
+// <name>,<run 0>;<run 1>;...;<run n - 1>
+// With counters enabled, a header line names the extra columns, each holding
+// one sample per run like the time column.
 #define setup()                                                               \
-        LARGE_INTEGER _t0;                                                    \
-        LARGE_INTEGER _t1;                                                    \
-        LARGE_INTEGER _f;                                                     \
-        long long _ts[_RUNS];
+        long long _t0;                                                        \
+        long long _tp;                                                        \
+        long long _paused;                                                    \
+        long long* _ts;                                                       \
+        int _runs;                                                            \
+        int _warmup;
 
 #define start()                                                               \
-        QueryPerformanceFrequency(&_f);                                       \
+        _runs = _bench_env("BENCHMARK_RUNS", BENCHMARK_RUNS);                 \
+        _warmup = _bench_env("BENCHMARK_WARMUP", BENCHMARK_WARMUP);           \
+        _ts = malloc(_runs * sizeof(long long));                              \
+        _bench_counters_open(_runs);                                          \
                                                                               \
         _Pragma("GCC diagnostic push");                                       \
         _Pragma("GCC diagnostic ignored \"-Wimplicit-function-declaration\"")
 
 #define benchmark(f)                                                          \
-        printf("%s,", #f);                                                    \
         f();                                                                  \
-        printf("%lld", _ts[0]);                                               \
-        for (int _i = 1; _i < _RUNS; ++_i)                                    \
-                printf(";%lld", _ts[_i]);                                     \
-        printf("\n");
+        _bench_print(#f, _ts, _runs);
 
+// For parameterized benchmarks, where one function is recorded under many
+// names: benchmark_named(name, f(a, b)).
+#define benchmark_named(name, call)                                           \
+        call;                                                                 \
+        _bench_print(name, _ts, _runs);
+
+// Everything between time_start and time_end runs _warmup + _runs times, only
+// the last _runs are recorded. Per-run setup that should not be measured goes
+// between time_pause and time_resume.
 #define time_start()                                                          \
-        for (int _i = 0; _i < _RUNS; ++_i)                                    \
+        for (int _i = -_warmup; _i < _runs; ++_i)                             \
         {                                                                     \
-                QueryPerformanceCounter(&_t0);
+                _paused = 0;                                                  \
+                _bench_counters_start();                                      \
+                _t0 = _bench_now();
+
+#define time_pause()                                                          \
+        _tp = _bench_now();                                                   \
+        _bench_counters_pause();
+
+#define time_resume()                                                         \
+        _bench_counters_resume();                                             \
+        _paused += _bench_now() - _tp;
 
 #define time_end()                                                            \
-        QueryPerformanceCounter(&_t1);                                        \
-        _ts[_i] = (long long)((_t1.QuadPart - _t0.QuadPart) * 1000.0          \
-                              / _f.QuadPart);                                 \
+        if (_i >= 0)                                                          \
+        {                                                                     \
+                _ts[_i] = _bench_now() - _t0 - _paused;                       \
+                _bench_counters_read(_i);                                     \
+        }                                                                     \
         }
 
 #define end()                                                                 \
         _Pragma("GCC diagnostic pop");                                        \
                                                                               \
+        _bench_counters_close();                                              \
+        free(_ts);                                                            \
         return 0;
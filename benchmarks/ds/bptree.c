@@ -0,0 +1,133 @@
+#include "../benchmarks.h"
+
+#include <ds/bptree.h>
+#include <ds/btree.h>
+
+setup();
+
+#define KEYS 1000000
+// Short scans start at a random key and visit this many entries.
+#define SCAN_LEN 100
+#define SCANS 10000
+
+int* keys;
+struct btree* btree;
+struct bptree* bptree;
+
+// Keeps searches and scans from being optimized away.
+volatile size_t sink;
+
+int
+main()
+{
+        start();
+
+        keys = malloc(KEYS * sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                keys[i] = rand();
+
+        btree = btree_create(sizeof(int), sizeof(int));
+        bptree = bptree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+        {
+                btree_insert(&btree, keys + i, keys + i, cmp_int);
+                bptree_insert(&bptree, keys + i, keys + i, cmp_int);
+        }
+
+        benchmark(btree_lookups);
+        benchmark(bptree_lookups);
+        benchmark(btree_full_scan);
+        benchmark(bptree_full_scan);
+        benchmark(btree_short_scans);
+        benchmark(bptree_short_scans);
+
+        btree_destroy(btree);
+        bptree_destroy(bptree);
+        free(keys);
+
+        end();
+}
+
+int
+btree_lookups()
+{
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink += btree_search(btree, keys + i, cmp_int) != NULL;
+        time_end();
+
+        return 0;
+}
+
+int
+bptree_lookups()
+{
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink += bptree_search(bptree, keys + i, cmp_int) != NULL;
+        time_end();
+
+        return 0;
+}
+
+int
+btree_full_scan()
+{
+        struct btree_cursor c;
+
+        time_start();
+        for (bool ok = btree_seek(&c, btree, NULL, cmp_int); ok;
+             ok = btree_next(&c))
+                sink += *(int*)btree_cursor_value(&c);
+        time_end();
+
+        return 0;
+}
+
+int
+bptree_full_scan()
+{
+        struct bptree_cursor c;
+
+        time_start();
+        for (bool ok = bptree_seek(&c, bptree, NULL, cmp_int); ok;
+             ok = bptree_next(&c))
+                sink += *(int*)bptree_cursor_value(&c);
+        time_end();
+
+        return 0;
+}
+
+int
+btree_short_scans()
+{
+        struct btree_cursor c;
+
+        time_start();
+        for (int i = 0; i < SCANS; ++i)
+        {
+                bool ok = btree_seek(&c, btree, keys + i, cmp_int);
+                for (int j = 0; ok && j < SCAN_LEN; ++j, ok = btree_next(&c))
+                        sink += *(int*)btree_cursor_value(&c);
+        }
+        time_end();
+
+        return 0;
+}
+
+int
+bptree_short_scans()
+{
+        struct bptree_cursor c;
+
+        time_start();
+        for (int i = 0; i < SCANS; ++i)
+        {
+                bool ok = bptree_seek(&c, bptree, keys + i, cmp_int);
+                for (int j = 0; ok && j < SCAN_LEN; ++j, ok = bptree_next(&c))
+                        sink += *(int*)bptree_cursor_value(&c);
+        }
+        time_end();
+
+        return 0;
+}
@@ -0,0 +1,247 @@
+// 320 parameter combinations, keep the run count low enough to finish.
+#define BENCHMARK_RUNS 10
+#define BENCHMARK_WARMUP 1
+
+#include "../benchmarks.h"
+
+#include <ds/btree.h>
+
+setup();
+
+#define KEYS 100000
+#define countof(a) (sizeof(a) / sizeof(*(a)))
+
+enum stream
+{
+        SEQUENTIAL,
+        RANDOM,
+        ZIPFIAN,
+};
+
+const char* stream_names[] = { "seq", "rand", "zipf" };
+size_t key_sizes[] = { 4, 8, 16, 32, 64 };
+size_t block_sizes[] = { 64, 128, 256, 512, 1024, 2048, 4096 };
+
+// Keys (and values) are key_size bytes: a big-endian index followed by
+// padding, so memcmp orders them like the index and pays for the full width
+// on equality.
+size_t key_size;
+byte* keys;
+// Indexes into keys, in the order they are inserted, searched or removed.
+size_t* stream;
+// A random permutation of all keys, used to build trees for search/remove.
+size_t* shuffled;
+
+// Keeps searches from being optimized away.
+volatile size_t sink;
+
+int
+main()
+{
+        char name[64];
+
+        start();
+
+        keys = malloc(KEYS * 64);
+        stream = malloc(KEYS * sizeof(size_t));
+        shuffled = malloc(KEYS * sizeof(size_t));
+
+        for (size_t k = 0; k < countof(key_sizes); ++k)
+        {
+                make_keys(key_sizes[k]);
+
+                sprintf(name, "bulk_load/k%zu", key_size);
+                benchmark_named(name, bulk_load_keys());
+
+                for (size_t s = SEQUENTIAL; s <= ZIPFIAN; ++s)
+                {
+                        make_stream(s);
+                        for (size_t b = 0; b < countof(block_sizes); ++b)
+                        {
+                                size_t block = block_sizes[b];
+
+                                sprintf(name, "insert/%s/k%zu/b%zu",
+                                        stream_names[s], key_size, block);
+                                benchmark_named(name, insert_keys(block));
+
+                                sprintf(name, "search/%s/k%zu/b%zu",
+                                        stream_names[s], key_size, block);
+                                benchmark_named(name, search_keys(block));
+
+                                sprintf(name, "remove/%s/k%zu/b%zu",
+                                        stream_names[s], key_size, block);
+                                benchmark_named(name, remove_keys(block));
+                        }
+                }
+        }
+
+        free(keys);
+        free(stream);
+        free(shuffled);
+
+        end();
+}
+
+int
+cmp_key(void* a, void* b)
+{
+        return memcmp(a, b, key_size);
+}
+
+byte*
+key(size_t idx)
+{
+        return keys + idx * key_size;
+}
+
+void
+shuffle(size_t* p, size_t n)
+{
+        for (size_t i = n - 1; i > 0; --i)
+        {
+                size_t j = rand() % (i + 1);
+                size_t tmp = p[i];
+                p[i] = p[j];
+                p[j] = tmp;
+        }
+}
+
+int
+make_keys(size_t size)
+{
+        key_size = size;
+        for (size_t i = 0; i < KEYS; ++i)
+        {
+                byte* k = key(i);
+                memset(k, 0xaa, key_size);
+                k[0] = i >> 24;
+                k[1] = i >> 16;
+                k[2] = i >> 8;
+                k[3] = i;
+        }
+
+        srand(0);
+        for (size_t i = 0; i < KEYS; ++i)
+                shuffled[i] = i;
+        shuffle(shuffled, KEYS);
+
+        return 0;
+}
+
+int
+make_stream(size_t s)
+{
+        for (size_t i = 0; i < KEYS; ++i)
+                stream[i] = i;
+
+        if (s == RANDOM)
+        {
+                shuffle(stream, KEYS);
+        }
+        else if (s == ZIPFIAN)
+        {
+                // Zipf (s = 1) over the shuffled keys: the key of rank r is
+                // drawn with probability proportional to 1 / r. Draws repeat,
+                // so inserts add duplicates and most removes miss.
+                double* cdf = malloc(KEYS * sizeof(double));
+                double sum = 0;
+                for (size_t r = 0; r < KEYS; ++r)
+                        cdf[r] = sum += 1.0 / (r + 1);
+
+                for (size_t i = 0; i < KEYS; ++i)
+                {
+                        double u = sum * rand() / ((double)RAND_MAX + 1);
+                        size_t lo = 0;
+                        size_t hi = KEYS - 1;
+                        while (lo < hi)
+                        {
+                                size_t mid = (lo + hi) / 2;
+                                if (cdf[mid] < u)
+                                        lo = mid + 1;
+                                else
+                                        hi = mid;
+                        }
+                        stream[i] = shuffled[lo];
+                }
+                free(cdf);
+        }
+
+        return 0;
+}
+
+struct btree*
+build(size_t block)
+{
+        struct btree* tree = btree_create_block(key_size, key_size, block);
+        for (size_t i = 0; i < KEYS; ++i)
+                btree_insert(&tree, key(shuffled[i]), key(shuffled[i]),
+                             cmp_key);
+        return tree;
+}
+
+int
+insert_keys(size_t block)
+{
+        time_start();
+        time_pause();
+        struct btree* tree = btree_create_block(key_size, key_size, block);
+        time_resume();
+
+        for (size_t i = 0; i < KEYS; ++i)
+                btree_insert(&tree, key(stream[i]), key(stream[i]), cmp_key);
+
+        time_pause();
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+search_keys(size_t block)
+{
+        struct btree* tree = build(block);
+
+        time_start();
+        for (size_t i = 0; i < KEYS; ++i)
+                sink += btree_search(tree, key(stream[i]), cmp_key) != NULL;
+        time_end();
+
+        btree_destroy(tree);
+        return 0;
+}
+
+int
+remove_keys(size_t block)
+{
+        time_start();
+        time_pause();
+        struct btree* tree = build(block);
+        time_resume();
+
+        for (size_t i = 0; i < KEYS; ++i)
+                btree_remove(&tree, key(stream[i]), cmp_key);
+
+        time_pause();
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+bulk_load_keys()
+{
+        // Same keys as insert/seq, loaded at once.
+        time_start();
+        struct btree* tree = btree_bulk_load(keys, keys, KEYS, key_size,
+                                             key_size, 1);
+        time_pause();
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
@@ -0,0 +1,108 @@
+#include "../benchmarks.h"
+
+#include <ds/btree.h>
+
+setup();
+
+#define KEYS 1000000
+#define BATCH 10000
+
+int* keys;
+void** found;
+
+// Keeps searches from being optimized away.
+volatile size_t sink;
+
+int
+main()
+{
+        start();
+
+        keys = malloc(KEYS * sizeof(int));
+        found = malloc(BATCH * sizeof(void*));
+        for (int i = 0; i < KEYS; ++i)
+                keys[i] = rand();
+
+        benchmark(inserts);
+        benchmark(insert_batches);
+        benchmark(searches);
+        benchmark(search_batches);
+
+        free(keys);
+        free(found);
+
+        end();
+}
+
+int
+inserts()
+{
+        time_start();
+        time_pause();
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        time_resume();
+
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_pause();
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+insert_batches()
+{
+        time_start();
+        time_pause();
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        time_resume();
+
+        for (int i = 0; i < KEYS; i += BATCH)
+                btree_insert_batch(&tree, keys + i, keys + i, BATCH, cmp_int);
+
+        time_pause();
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+searches()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink += btree_search(tree, keys + i, cmp_int) != NULL;
+        time_end();
+
+        btree_destroy(tree);
+        return 0;
+}
+
+int
+search_batches()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_start();
+        for (int i = 0; i < KEYS; i += BATCH)
+        {
+                btree_search_batch(tree, keys + i, BATCH, found, cmp_int);
+                sink += found[0] != NULL;
+        }
+        time_end();
+
+        btree_destroy(tree);
+        return 0;
+}
@@ -0,0 +1,104 @@
+#include "../benchmarks.h"
+
+#include <ds/btree.h>
+#include <ds/btree_define.h>
+
+BTREE_DEFINE(itree, int, int, (a > b) - (a < b))
+
+setup();
+
+#define KEYS 1000000
+
+int* keys;
+
+// Keeps searches from being optimized away.
+volatile size_t sink;
+
+int
+main()
+{
+        start();
+
+        keys = malloc(KEYS * sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                keys[i] = rand();
+
+        benchmark(btree_inserts);
+        benchmark(typed_inserts);
+        benchmark(btree_searches);
+        benchmark(typed_searches);
+
+        free(keys);
+
+        end();
+}
+
+int
+btree_inserts()
+{
+        time_start();
+        time_pause();
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        time_resume();
+
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_pause();
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+typed_inserts()
+{
+        time_start();
+        time_pause();
+        struct itree* tree = itree_create();
+        time_resume();
+
+        for (int i = 0; i < KEYS; ++i)
+                itree_insert(&tree, keys[i], keys[i]);
+
+        time_pause();
+        itree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+btree_searches()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink += btree_search(tree, keys + i, cmp_int) != NULL;
+        time_end();
+
+        btree_destroy(tree);
+        return 0;
+}
+
+int
+typed_searches()
+{
+        struct itree* tree = itree_create();
+        for (int i = 0; i < KEYS; ++i)
+                itree_insert(&tree, keys[i], keys[i]);
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink += itree_search(tree, keys[i]) != NULL;
+        time_end();
+
+        itree_destroy(tree);
+        return 0;
+}
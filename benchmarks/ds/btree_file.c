@@ -0,0 +1,109 @@
+#include "../benchmarks.h"
+
+#include <ds/btree_file.h>
+
+setup();
+
+#define KEYS 1000000
+#define PATH "btree_file.bench"
+
+int* keys;
+struct btree* tree;
+
+// Keeps searches from being optimized away.
+volatile int sink;
+
+int
+main()
+{
+        start();
+
+        keys = malloc(KEYS * sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                keys[i] = rand();
+
+        tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+        btree_file_write(tree, PATH);
+
+        benchmark(rebuild);
+        benchmark(write_file);
+        benchmark(open_file);
+        benchmark(search_memory);
+        benchmark(search_file);
+
+        btree_destroy(tree);
+        remove(PATH);
+        free(keys);
+
+        end();
+}
+
+// What a restart costs without a file.
+int
+rebuild()
+{
+        time_start();
+        struct btree* rebuilt = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&rebuilt, keys + i, keys + i, cmp_int);
+
+        time_pause();
+        btree_destroy(rebuilt);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+write_file()
+{
+        time_start();
+        btree_file_write(tree, PATH);
+        time_end();
+
+        return 0;
+}
+
+// What a restart costs with a file, up to the first lookup.
+int
+open_file()
+{
+        time_start();
+        struct btree_file* f = btree_file_open(PATH);
+        sink = *(int*)btree_file_search(f, keys, cmp_int);
+
+        time_pause();
+        btree_file_close(f);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+search_memory()
+{
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink = *(int*)btree_search(tree, keys + i, cmp_int);
+        time_end();
+
+        return 0;
+}
+
+int
+search_file()
+{
+        struct btree_file* f = btree_file_open(PATH);
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink = *(int*)btree_file_search(f, keys + i, cmp_int);
+        time_end();
+
+        btree_file_close(f);
+        return 0;
+}
@@ -0,0 +1,124 @@
+#include "../benchmarks.h"
+
+#include <ds/btree.h>
+#include <ds/btree_olc.h>
+#include <pthread.h>
+
+setup();
+
+#define KEYS 1000000
+#define OPS 1000000
+// Percentage of operations that insert instead of searching.
+#define WRITES 10
+
+int* keys;
+
+struct btree_olc* olc_tree;
+struct btree* mutex_tree;
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+int threadno;
+// Keeps the compiler from dropping the loads of values found.
+volatile int sink;
+
+// Each thread runs its share of OPS on keys from its own slice of the
+// prepopulated ones, so every configuration does the same amount of work.
+void*
+olc_worker(void* arg)
+{
+        size_t id = (size_t)arg;
+        unsigned seed = id;
+        int val;
+
+        for (int i = 0; i < OPS / threadno; ++i)
+        {
+                int* key = keys + rand_r(&seed) % KEYS;
+                if (rand_r(&seed) % 100 < WRITES)
+                        btree_olc_insert(olc_tree, key, key, cmp_int);
+                else
+                        btree_olc_search(olc_tree, key, &val, cmp_int);
+        }
+
+        return NULL;
+}
+
+void*
+mutex_worker(void* arg)
+{
+        size_t id = (size_t)arg;
+        unsigned seed = id;
+
+        for (int i = 0; i < OPS / threadno; ++i)
+        {
+                int* key = keys + rand_r(&seed) % KEYS;
+                bool write = rand_r(&seed) % 100 < WRITES;
+                pthread_mutex_lock(&mutex);
+                // btree_insert adds duplicates, so writes replace the value
+                // in place like btree_olc_insert does.
+                int* val = btree_search(mutex_tree, key, cmp_int);
+                if (val == NULL)
+                        btree_insert(&mutex_tree, key, key, cmp_int);
+                else if (write)
+                        *val = *key;
+                else
+                        sink = *val;
+                pthread_mutex_unlock(&mutex);
+        }
+
+        return NULL;
+}
+
+int
+run(void* (*worker)(void*))
+{
+        pthread_t threads[threadno];
+
+        time_start();
+        for (int i = 0; i < threadno; ++i)
+                pthread_create(threads + i, NULL, worker, (void*)(size_t)i);
+        for (int i = 0; i < threadno; ++i)
+                pthread_join(threads[i], NULL);
+        time_end();
+
+        return 0;
+}
+
+int
+main()
+{
+        char name[64];
+
+        start();
+
+        keys = malloc(KEYS * sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                keys[i] = rand();
+
+        olc_tree = btree_olc_create(sizeof(int), sizeof(int));
+        mutex_tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+        {
+                btree_olc_insert(olc_tree, keys + i, keys + i, cmp_int);
+                btree_insert(&mutex_tree, keys + i, keys + i, cmp_int);
+        }
+
+        // Doubles the threads up to the cores online, ending on the cores
+        // themselves if they are not a power of 2.
+        int cores = sysconf(_SC_NPROCESSORS_ONLN);
+        for (threadno = 1; threadno <= cores;
+             threadno = threadno < cores && threadno * 2 > cores
+                            ? cores
+                            : threadno * 2)
+        {
+                sprintf(name, "olc/t%d", threadno);
+                benchmark_named(name, run(olc_worker));
+
+                sprintf(name, "mutex/t%d", threadno);
+                benchmark_named(name, run(mutex_worker));
+        }
+
+        btree_olc_destroy(olc_tree);
+        btree_destroy(mutex_tree);
+        free(keys);
+
+        end();
+}
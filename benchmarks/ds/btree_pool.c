@@ -0,0 +1,142 @@
+#include "../benchmarks.h"
+
+#include <ds/btree.h>
+
+setup();
+
+#define KEYS 1000000
+
+int* keys;
+
+int
+main()
+{
+        start();
+
+        keys = malloc(KEYS * sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                keys[i] = rand();
+
+        benchmark(malloc_inserts);
+        benchmark(pooled_inserts);
+        benchmark(malloc_churn);
+        benchmark(pooled_churn);
+        benchmark(destroy);
+        benchmark(pool_reset);
+
+        free(keys);
+
+        end();
+}
+
+int
+malloc_inserts()
+{
+        time_start();
+        time_pause();
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        time_resume();
+
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_pause();
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+pooled_inserts()
+{
+        struct btree_pool* pool = btree_pool_create(sizeof(int), sizeof(int));
+
+        time_start();
+        time_pause();
+        btree_pool_reset(pool);
+        struct btree* tree = btree_create_pooled(pool);
+        time_resume();
+
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_end();
+
+        btree_pool_destroy(pool);
+        return 0;
+}
+
+// Removes and reinserts every key, splitting and merging nodes all along.
+int
+malloc_churn()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                btree_remove(&tree, keys + i, cmp_int);
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+        time_end();
+
+        btree_destroy(tree);
+        return 0;
+}
+
+int
+pooled_churn()
+{
+        struct btree_pool* pool = btree_pool_create(sizeof(int), sizeof(int));
+        struct btree* tree = btree_create_pooled(pool);
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                btree_remove(&tree, keys + i, cmp_int);
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+        time_end();
+
+        btree_pool_destroy(pool);
+        return 0;
+}
+
+int
+destroy()
+{
+        time_start();
+        time_pause();
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+        time_resume();
+
+        btree_destroy(tree);
+        time_end();
+
+        return 0;
+}
+
+int
+pool_reset()
+{
+        struct btree_pool* pool = btree_pool_create(sizeof(int), sizeof(int));
+
+        time_start();
+        time_pause();
+        struct btree* tree = btree_create_pooled(pool);
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+        time_resume();
+
+        btree_pool_reset(pool);
+        time_end();
+
+        btree_pool_destroy(pool);
+        return 0;
+}
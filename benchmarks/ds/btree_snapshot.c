@@ -0,0 +1,99 @@
+#include "../benchmarks.h"
+
+#include <ds/btree.h>
+
+setup();
+
+#define KEYS 1000000
+// Inserts between snapshots, for a background reader that keeps the latest.
+#define INTERVAL 1024
+
+int* keys;
+
+int
+main()
+{
+        start();
+
+        keys = malloc(KEYS * sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                keys[i] = rand();
+
+        benchmark(inserts);
+        benchmark(snapshotted_inserts);
+        benchmark(snapshot_first_write);
+
+        free(keys);
+
+        end();
+}
+
+int
+inserts()
+{
+        time_start();
+        time_pause();
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        time_resume();
+
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_pause();
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+// Every snapshot makes the next inserts copy the nodes on their paths.
+int
+snapshotted_inserts()
+{
+        time_start();
+        time_pause();
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        struct btree* snap = btree_snapshot(tree);
+        time_resume();
+
+        for (int i = 0; i < KEYS; ++i)
+        {
+                if (i % INTERVAL == 0)
+                {
+                        btree_destroy(snap);
+                        snap = btree_snapshot(tree);
+                }
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+        }
+
+        time_pause();
+        btree_destroy(snap);
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+// Taking a snapshot of a full tree, and the path copy of the first write.
+int
+snapshot_first_write()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_start();
+        struct btree* snap = btree_snapshot(tree);
+        btree_insert(&tree, keys, keys, cmp_int);
+
+        time_pause();
+        btree_destroy(tree);
+        tree = snap;
+        time_resume();
+        time_end();
+
+        btree_destroy(tree);
+        return 0;
+}
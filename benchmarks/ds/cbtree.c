@@ -0,0 +1,102 @@
+#include "../benchmarks.h"
+
+#include <ds/btree.h>
+#include <ds/cbtree.h>
+
+setup();
+
+#define KEYS 1000000
+
+int* keys;
+
+// Keeps searches from being optimized away.
+volatile size_t sink;
+
+int
+main()
+{
+        start();
+
+        keys = malloc(KEYS * sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                keys[i] = rand();
+
+        benchmark(btree_inserts);
+        benchmark(cbtree_inserts);
+        benchmark(btree_searches);
+        benchmark(cbtree_searches);
+
+        free(keys);
+
+        end();
+}
+
+int
+btree_inserts()
+{
+        time_start();
+        time_pause();
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        time_resume();
+
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_pause();
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+cbtree_inserts()
+{
+        time_start();
+        time_pause();
+        struct cbtree* tree = cbtree_create(sizeof(int), sizeof(int));
+        time_resume();
+
+        for (int i = 0; i < KEYS; ++i)
+                cbtree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_pause();
+        cbtree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+btree_searches()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink += btree_search(tree, keys + i, cmp_int) != NULL;
+        time_end();
+
+        btree_destroy(tree);
+        return 0;
+}
+
+int
+cbtree_searches()
+{
+        struct cbtree* tree = cbtree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                cbtree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink += cbtree_search(tree, keys + i, cmp_int) != NULL;
+        time_end();
+
+        cbtree_destroy(tree);
+        return 0;
+}
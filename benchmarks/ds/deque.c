@@ -0,0 +1,72 @@
+#include "../benchmarks.h"
+
+#include <ds/deque.h>
+#include <ds/slice.h>
+
+setup();
+
+#define OPS 1000000
+// Elements kept queued while OPS go through the queue.
+#define QUEUED 4096
+
+int
+main()
+{
+        start();
+
+        benchmark(slice_fifo);
+        benchmark(deque_fifo);
+
+        end();
+}
+
+// A queue on a slice pops the front by shifting everything behind it.
+int
+slice_fifo()
+{
+        time_start();
+        time_pause();
+        struct slice* s = slice_make(sizeof(int), QUEUED + 1);
+        for (int i = 0; i < QUEUED; ++i)
+                slice_append(s, &i);
+        time_resume();
+
+        for (int i = 0; i < OPS; ++i)
+        {
+                slice_sappend(s, &i);
+                slice_delete_at(s, 0);
+        }
+
+        time_pause();
+        slice_del(s);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+deque_fifo()
+{
+        int el;
+
+        time_start();
+        time_pause();
+        struct deque* d = deque_create(sizeof(int), QUEUED + 1);
+        for (int i = 0; i < QUEUED; ++i)
+                deque_push_back(d, &i);
+        time_resume();
+
+        for (int i = 0; i < OPS; ++i)
+        {
+                deque_push_back(d, &i);
+                deque_pop_front(d, &el);
+        }
+
+        time_pause();
+        deque_destroy(d);
+        time_resume();
+        time_end();
+
+        return 0;
+}
@@ -0,0 +1,116 @@
+#include "../benchmarks.h"
+
+#include <ds/btree.h>
+#include <ds/hmap.h>
+
+setup();
+
+#define KEYS 1000000
+
+int* keys;
+// Order of the lookups, a different permutation than the inserts.
+int* lookups;
+
+// Keeps searches from being optimized away.
+volatile int sink;
+
+int
+main()
+{
+        start();
+
+        keys = malloc(KEYS * sizeof(int));
+        lookups = malloc(KEYS * sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                keys[i] = rand();
+        for (int i = 0; i < KEYS; ++i)
+                lookups[i] = keys[rand() % KEYS];
+
+        benchmark(insert_btree);
+        benchmark(insert_hmap);
+        benchmark(search_btree);
+        benchmark(search_hmap);
+        benchmark(search_hmap_bytes);
+
+        free(keys);
+        free(lookups);
+
+        end();
+}
+
+int
+insert_btree()
+{
+        time_start();
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_pause();
+        btree_destroy(tree);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+insert_hmap()
+{
+        time_start();
+        struct hmap* m
+            = hmap_create(sizeof(int), sizeof(int), hmap_hash_int, NULL);
+        for (int i = 0; i < KEYS; ++i)
+                hmap_insert(m, keys + i, keys + i);
+
+        time_pause();
+        hmap_destroy(m);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+search_btree()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < KEYS; ++i)
+                btree_insert(&tree, keys + i, keys + i, cmp_int);
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink = *(int*)btree_search(tree, lookups + i, cmp_int);
+        time_end();
+
+        btree_destroy(tree);
+        return 0;
+}
+
+int
+search_hash(size_t (*hash)(data*, size_t))
+{
+        struct hmap* m = hmap_create(sizeof(int), sizeof(int), hash, NULL);
+        for (int i = 0; i < KEYS; ++i)
+                hmap_insert(m, keys + i, keys + i);
+
+        time_start();
+        for (int i = 0; i < KEYS; ++i)
+                sink = *(int*)hmap_search(m, lookups + i);
+        time_end();
+
+        hmap_destroy(m);
+        return 0;
+}
+
+int
+search_hmap()
+{
+        return search_hash(hmap_hash_int);
+}
+
+int
+search_hmap_bytes()
+{
+        return search_hash(hmap_hash_bytes);
+}
@@ -0,0 +1,111 @@
+#include "../benchmarks.h"
+
+#include <ds/slice.h>
+
+setup();
+
+#define ELEMENTS 4000000
+// Elements moved by each bulk call, about a B-tree node's worth.
+#define BATCH 64
+// Deletions hit the front of a smaller slice, so each one shifts it whole.
+#define SHIFTED 65536
+
+int* els;
+
+int
+main()
+{
+        start();
+
+        els = malloc(ELEMENTS * sizeof(int));
+        for (int i = 0; i < ELEMENTS; ++i)
+                els[i] = i;
+
+        benchmark(append_each);
+        benchmark(append_batches);
+        benchmark(delete_each);
+        benchmark(delete_batches);
+
+        free(els);
+
+        end();
+}
+
+int
+append_each()
+{
+        time_start();
+        time_pause();
+        struct slice* s = slice_make(sizeof(int), ELEMENTS);
+        time_resume();
+
+        for (int i = 0; i < ELEMENTS; ++i)
+                slice_sappend(s, els + i);
+
+        time_pause();
+        slice_del(s);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+append_batches()
+{
+        time_start();
+        time_pause();
+        struct slice* s = slice_make(sizeof(int), ELEMENTS);
+        time_resume();
+
+        for (int i = 0; i < ELEMENTS; i += BATCH)
+                slice_append_n(s, els + i, BATCH);
+
+        time_pause();
+        slice_del(s);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+delete_each()
+{
+        time_start();
+        time_pause();
+        struct slice* s = slice_make(sizeof(int), SHIFTED);
+        slice_append_n(s, els, SHIFTED);
+        time_resume();
+
+        for (int i = 0; i < SHIFTED; i += BATCH)
+                for (int j = 0; j < BATCH; ++j)
+                        slice_delete_at(s, 0);
+
+        time_pause();
+        slice_del(s);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+delete_batches()
+{
+        time_start();
+        time_pause();
+        struct slice* s = slice_make(sizeof(int), SHIFTED);
+        slice_append_n(s, els, SHIFTED);
+        time_resume();
+
+        for (int i = 0; i < SHIFTED; i += BATCH)
+                slice_delete_range(s, 0, BATCH);
+
+        time_pause();
+        slice_del(s);
+        time_resume();
+        time_end();
+
+        return 0;
+}
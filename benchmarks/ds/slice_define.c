@@ -0,0 +1,100 @@
+#include "../benchmarks.h"
+
+#include <ds/slice.h>
+#include <ds/slice_define.h>
+
+SLICE_DEFINE(ints, int)
+
+setup();
+
+#define ELEMENTS 10000000
+// Sums run over a slice that fits in cache, so the loop is what's measured.
+#define SUMMED 4096
+#define ROUNDS 2500
+
+// Keeps sums from being optimized away.
+volatile long sink;
+
+int
+main()
+{
+        start();
+
+        benchmark(slice_pushes);
+        benchmark(typed_pushes);
+        benchmark(slice_sums);
+        benchmark(typed_sums);
+
+        end();
+}
+
+int
+slice_pushes()
+{
+        time_start();
+        struct slice* s = slice_make(sizeof(int), 16);
+        for (int i = 0; i < ELEMENTS; ++i)
+                slice_sappend(s, &i);
+
+        time_pause();
+        slice_del(s);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+typed_pushes()
+{
+        time_start();
+        struct ints* s = ints_make(16);
+        for (int i = 0; i < ELEMENTS; ++i)
+                ints_push(s, i);
+
+        time_pause();
+        ints_del(s);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+int
+slice_sums()
+{
+        struct slice* s = slice_make(sizeof(int), SUMMED);
+        for (int i = 0; i < SUMMED; ++i)
+                slice_append(s, &i);
+
+        time_start();
+        long sum = 0;
+        for (int r = 0; r < ROUNDS; ++r)
+                for (size_t i = 0; i < s->len; ++i)
+                        sum += *(int*)slice_at(s, i);
+        sink = sum;
+        time_end();
+
+        slice_del(s);
+        return 0;
+}
+
+// Same loop with the element size known, which the compiler vectorizes.
+int
+typed_sums()
+{
+        struct ints* s = ints_make(SUMMED);
+        for (int i = 0; i < SUMMED; ++i)
+                ints_push(s, i);
+
+        time_start();
+        long sum = 0;
+        for (int r = 0; r < ROUNDS; ++r)
+                for (size_t i = 0; i < s->len; ++i)
+                        sum += *ints_at(s, i);
+        sink = sum;
+        time_end();
+
+        ints_del(s);
+        return 0;
+}
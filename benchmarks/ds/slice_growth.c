@@ -0,0 +1,67 @@
+#include "../benchmarks.h"
+
+#include <ds/slice.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+setup();
+
+#define ELEMENTS 16000000
+
+const char* names[] = { "scale", "half", "chunk", "hugepage" };
+
+int
+appends(enum slice_growth growth)
+{
+        time_start();
+        struct slice* s = slice_make(sizeof(int), 16);
+        slice_set_growth(s, growth);
+        for (int i = 0; i < ELEMENTS; ++i)
+                slice_sappend(s, &i);
+
+        time_pause();
+        slice_del(s);
+        time_resume();
+        time_end();
+
+        return 0;
+}
+
+// Peak RSS only goes up within a process, so each policy appends on its own
+// child. Reported on stderr so the CSV only holds timings.
+void
+peak_rss(enum slice_growth growth)
+{
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+                struct slice* s = slice_make(sizeof(int), 16);
+                slice_set_growth(s, growth);
+                for (int i = 0; i < ELEMENTS; ++i)
+                        slice_sappend(s, &i);
+                _exit(0);
+        }
+
+        struct rusage usage;
+        wait4(pid, NULL, 0, &usage);
+        fprintf(stderr, "%s: %ld KiB peak RSS for %zu KiB of elements\n",
+                names[growth], usage.ru_maxrss,
+                ELEMENTS * sizeof(int) / 1024);
+}
+
+int
+main()
+{
+        char name[64];
+
+        start();
+
+        for (int g = SLICE_GROW_SCALE; g <= SLICE_GROW_HUGEPAGE; ++g)
+        {
+                sprintf(name, "appends/%s", names[g]);
+                benchmark_named(name, appends(g));
+                peak_rss(g);
+        }
+
+        end();
+}
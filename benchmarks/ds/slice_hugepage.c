@@ -0,0 +1,50 @@
+#include "../benchmarks.h"
+
+#include <ds/slice.h>
+
+setup();
+
+// 256 MiB of elements, far more than the TLB covers with 4 KiB pages.
+#define ELEMENTS (64 * 1024 * 1024)
+#define READS 10000000
+
+unsigned* idx;
+
+// Keeps reads from being optimized away.
+volatile long sink;
+
+int
+random_reads(enum slice_growth growth)
+{
+        struct slice* s = slice_make(sizeof(int), 16);
+        slice_set_growth(s, growth);
+        for (int i = 0; i < ELEMENTS; ++i)
+                slice_sappend(s, &i);
+
+        time_start();
+        long sum = 0;
+        for (int i = 0; i < READS; ++i)
+                sum += *(int*)slice_at(s, idx[i]);
+        sink = sum;
+        time_end();
+
+        slice_del(s);
+        return 0;
+}
+
+int
+main()
+{
+        start();
+
+        idx = malloc(READS * sizeof(unsigned));
+        for (int i = 0; i < READS; ++i)
+                idx[i] = ((unsigned)rand() << 16 ^ rand()) % ELEMENTS;
+
+        benchmark_named("reads/heap", random_reads(SLICE_GROW_SCALE));
+        benchmark_named("reads/hugepage", random_reads(SLICE_GROW_HUGEPAGE));
+
+        free(idx);
+
+        end();
+}
@@ -0,0 +1,83 @@
+#include "../benchmarks.h"
+
+#include <ds/slice.h>
+
+setup();
+
+#define SLICES 1000000
+// Elements on each short-lived slice, which all fit inline.
+#define ELEMENTS 8
+
+// Keeps the slices from being optimized away.
+volatile int sink;
+
+int
+main()
+{
+        start();
+
+        benchmark(heap);
+        benchmark(inline_storage);
+        benchmark(caller_memory);
+
+        end();
+}
+
+int
+fill(struct slice* s)
+{
+        for (int i = 0; i < ELEMENTS; ++i)
+                slice_sappend(s, &i);
+        sink = *(int*)slice_last(s);
+
+        return 0;
+}
+
+// Two allocations per slice, for the handle and the array.
+int
+heap()
+{
+        time_start();
+        for (int i = 0; i < SLICES; ++i)
+        {
+                struct slice* s = slice_make(sizeof(int), ELEMENTS);
+                fill(s);
+                slice_del(s);
+        }
+        time_end();
+
+        return 0;
+}
+
+int
+inline_storage()
+{
+        time_start();
+        for (int i = 0; i < SLICES; ++i)
+        {
+                struct slice* s = slice_make_inline(sizeof(int), ELEMENTS);
+                fill(s);
+                slice_del(s);
+        }
+        time_end();
+
+        return 0;
+}
+
+int
+caller_memory()
+{
+        size_t mem[16];
+
+        time_start();
+        for (int i = 0; i < SLICES; ++i)
+        {
+                struct slice* s
+                    = slice_make_in(mem, sizeof(mem), sizeof(int));
+                fill(s);
+                slice_release(s);
+        }
+        time_end();
+
+        return 0;
+}
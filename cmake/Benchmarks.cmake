@@ -2,37 +2,84 @@ find_package(Python COMPONENTS Interpreter)
 
 add_custom_target(benchmarks)
 add_custom_target(charts)
+add_custom_target(reports)
+add_custom_target(baselines)
 set(BENCHMARK_CHART "${CMAKE_SOURCE_DIR}/scripts/benchmark_chart.py")
+set(BENCHMARK_REPORT "${CMAKE_SOURCE_DIR}/scripts/benchmark_report.py")
+set(BENCHMARK_BASELINE_DIR "${CMAKE_SOURCE_DIR}/benchmarks/baselines")
+set(BENCHMARK_THRESHOLD 5 CACHE STRING
+    "Slowdown of the median (in percent) reported as a regression."
+)
 set(BENCHMARK_OUTPUT_DIR "${CMAKE_CURRENT_BINARY_DIR}/results")
 file(MAKE_DIRECTORY ${BENCHMARK_OUTPUT_DIR})
 
+# Every benchmark is built once per optimization profile, so charts show which
+# costs survive the optimizer and which only exist on unoptimized builds.
+set(BENCHMARK_PROFILES O0 O2 O3native LTO)
+set(BENCHMARK_FLAGS_O0 -O0)
+set(BENCHMARK_FLAGS_O2 -O2)
+set(BENCHMARK_FLAGS_O3native -O3 -march=native)
+set(BENCHMARK_FLAGS_LTO -O3 -march=native -flto)
+set(BENCHMARK_LINK_FLAGS_LTO -flto)
+
 function(leet_benchmark SOURCE)
     string(REPLACE ".c" "" TARGET ${SOURCE})
     string(REPLACE "/" "." TARGET ${TARGET})
     string(PREPEND TARGET "bench.")
 
     set(RUNNER "${TARGET}.runner")
+    set(BENCHMARK_CSVS "")
 
-    add_executable(${TARGET} ${SOURCE})
-    target_link_libraries(${TARGET} PRIVATE leet)
-    target_compile_options(${TARGET} PRIVATE "-O0")
+    foreach(PROFILE ${BENCHMARK_PROFILES})
+        set(PROFILE_TARGET "${TARGET}.${PROFILE}")
 
-    set(BENCHMARK_BINARY "${CMAKE_CURRENT_BINARY_DIR}/${TARGET}.exe")
-    set(BENCHMARK_CSV "${BENCHMARK_OUTPUT_DIR}/${TARGET}.csv")
-    add_custom_command(
-        OUTPUT ${BENCHMARK_CSV}
-        DEPENDS ${TARGET} ${SOURCE}
+        add_executable(${PROFILE_TARGET} ${SOURCE})
+        target_link_libraries(${PROFILE_TARGET} PRIVATE leet)
+        target_compile_options(
+            ${PROFILE_TARGET} PRIVATE ${BENCHMARK_FLAGS_${PROFILE}}
+        )
+        target_link_options(
+            ${PROFILE_TARGET} PRIVATE ${BENCHMARK_LINK_FLAGS_${PROFILE}}
+        )
+
+        set(BENCHMARK_CSV "${BENCHMARK_OUTPUT_DIR}/${PROFILE_TARGET}.csv")
+        add_custom_command(
+            OUTPUT ${BENCHMARK_CSV}
+            DEPENDS ${PROFILE_TARGET} ${SOURCE}
+            COMMAND
+            $<TARGET_FILE:${PROFILE_TARGET}> > ${BENCHMARK_CSV}
+            WORKING_DIRECTORY ${BENCHMARK_OUTPUT_DIR}
+        )
+        list(APPEND BENCHMARK_CSVS ${BENCHMARK_CSV})
+    endforeach()
+
+    add_custom_target(${RUNNER} DEPENDS ${BENCHMARK_CSVS})
+    add_dependencies(benchmarks ${RUNNER})
+
+    # Fails the build if any run regressed against the committed baseline.
+    add_custom_target(
+        ${TARGET}.report
         COMMAND
-        ${BENCHMARK_BINARY} > ${BENCHMARK_CSV}
-        WORKING_DIRECTORY ${BENCHMARK_OUTPUT_DIR}
+        ${Python_EXECUTABLE} ${BENCHMARK_REPORT} ${BENCHMARK_CSVS}
+        --baseline ${BENCHMARK_BASELINE_DIR}
+        --threshold ${BENCHMARK_THRESHOLD}
+        DEPENDS ${BENCHMARK_CSVS}
     )
-    add_custom_target(${RUNNER} DEPENDS ${BENCHMARK_CSV})
-    add_dependencies(benchmarks ${RUNNER})
+    add_dependencies(reports ${TARGET}.report)
+
+    add_custom_target(
+        ${TARGET}.baseline
+        COMMAND
+        ${Python_EXECUTABLE} ${BENCHMARK_REPORT} ${BENCHMARK_CSVS}
+        --baseline ${BENCHMARK_BASELINE_DIR} --update
+        DEPENDS ${BENCHMARK_CSVS}
+    )
+    add_dependencies(baselines ${TARGET}.baseline)
 endfunction()
 
 function(leet_chart)
-    set(oneValueArgs SOURCE NAME)
-    set(multiValueArgs RUNS)
+    set(oneValueArgs SOURCE NAME METRIC)
+    set(multiValueArgs RUNS PROFILES)
     cmake_parse_arguments(
         CHART
         ""
@@ -40,6 +87,12 @@ function(leet_chart)
         "${multiValueArgs}"
         ${ARGN}
     )
+    if(NOT CHART_METRIC)
+        set(CHART_METRIC ns)
+    endif()
+    if(NOT CHART_PROFILES)
+        set(CHART_PROFILES ${BENCHMARK_PROFILES})
+    endif()
 
     string(REPLACE ".c" "" TARGET ${CHART_SOURCE})
     string(REPLACE "/" "." TARGET ${TARGET})
@@ -47,14 +100,22 @@ function(leet_chart)
     string(PREPEND CHART "chart.")
     string(PREPEND TARGET "bench.")
 
-    set(BENCHMARK_CSV "${BENCHMARK_OUTPUT_DIR}/${TARGET}.csv")
+    set(BENCHMARK_CSVS "")
+    foreach(PROFILE ${CHART_PROFILES})
+        list(
+            APPEND BENCHMARK_CSVS
+            "${BENCHMARK_OUTPUT_DIR}/${TARGET}.${PROFILE}.csv"
+        )
+    endforeach()
+
     set(CHART_JSON "${CMAKE_SOURCE_DIR}/docs/_charts/bench.${CHART_NAME}.json")
     add_custom_command(
         OUTPUT ${CHART_JSON}
-        DEPENDS ${BENCHMARK_CSV}
+        DEPENDS ${BENCHMARK_CSVS}
         COMMAND
         ${Python_EXECUTABLE} ${BENCHMARK_CHART}
-        ${BENCHMARK_CSV} ${CHART_JSON} ${CHART_RUNS}
+        ${CHART_JSON} --runs ${CHART_RUNS} --csv ${BENCHMARK_CSVS}
+        --metric ${CHART_METRIC}
     )
     add_custom_target(${CHART} DEPENDS ${CHART_JSON})
     add_dependencies(charts ${CHART})
@@ -0,0 +1,304 @@
+#pragma once
+#pragma icanc include
+#include <leet.h>
+#pragma icanc end
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define _SEARCH_X86
+#endif
+
+/**
+ * @file search.h
+ *
+ * `#include <alg/search.h>`
+ *
+ * Searches over *sorted* arrays, such as the keys on a B-tree node. Every
+ * search returns the lower bound of the key: the index of the first element
+ * that is not smaller than the key, or the number of elements if there is
+ * none.
+ *
+ * @ref search_lower_bound picks the fastest search for the given comparator.
+ * Keys compared with @ref search_cmp_i32 or @ref search_cmp_i64 are searched
+ * with SIMD comparisons when the CPU supports them, other keys with a
+ * branchless binary search.
+ */
+
+/**
+ * @brief Comparator for `int32_t` keys.
+ *
+ * Passing this comparator to @ref search_lower_bound (or to data structures
+ * that search with it) enables the SIMD search for 32 bit integers.
+ *
+ * @param a Pointer to an `int32_t`.
+ * @param b Pointer to an `int32_t`.
+ */
+int
+search_cmp_i32(void* a, void* b)
+{
+        int32_t x = *(int32_t*)a;
+        int32_t y = *(int32_t*)b;
+        return (x > y) - (x < y);
+}
+
+/**
+ * @brief Comparator for `int64_t` keys.
+ *
+ * Passing this comparator to @ref search_lower_bound (or to data structures
+ * that search with it) enables the SIMD search for 64 bit integers.
+ *
+ * @param a Pointer to an `int64_t`.
+ * @param b Pointer to an `int64_t`.
+ */
+int
+search_cmp_i64(void* a, void* b)
+{
+        int64_t x = *(int64_t*)a;
+        int64_t y = *(int64_t*)b;
+        return (x > y) - (x < y);
+}
+
+/**
+ * @brief Finds the lower bound of a key by comparing it to every element in
+ * order.
+ *
+ * Calls the comparator once per element smaller than the key. Included as the
+ * baseline the other searches are measured against.
+ *
+ * @param base Pointer to the first element of the array.
+ * @param n Number of elements on the array.
+ * @param el_size Size of each element.
+ * @param key Pointer to the key to search for.
+ * @param cmp Search comparator.
+ * @return Index of the first element not smaller than the key.
+ */
+size_t
+search_linear(data* base, size_t n, size_t el_size, data* key,
+              int (*cmp)(void*, void*))
+{
+        size_t i = 0;
+        while (i < n && cmp(key, (byte*)base + i * el_size) > 0)
+        {
+                ++i;
+        }
+        return i;
+}
+
+/**
+ * @brief Finds the lower bound of a key with a branchless binary search.
+ *
+ * Calls the comparator `log2(n) + 1` times. The loop always runs the same
+ * number of times for a given `n` and the comparison only selects the next
+ * base, which compiles to a conditional move instead of a branch the CPU has
+ * to guess.
+ *
+ * @param base Pointer to the first element of the array.
+ * @param n Number of elements on the array.
+ * @param el_size Size of each element.
+ * @param key Pointer to the key to search for.
+ * @param cmp Search comparator.
+ * @return Index of the first element not smaller than the key.
+ */
+size_t
+search_binary(data* base, size_t n, size_t el_size, data* key,
+              int (*cmp)(void*, void*))
+{
+        if (n == 0)
+        {
+                return 0;
+        }
+
+        byte* first = base;
+        byte* p = base;
+        while (n > 1)
+        {
+                // Invariant: the lower bound is in [p, p + n].
+                size_t half = n / 2;
+                p = cmp(key, p + (half - 1) * el_size) > 0 ? p + half * el_size
+                                                           : p;
+                n -= half;
+        }
+
+        return (p - first) / el_size + (cmp(key, p) > 0);
+}
+
+#ifdef _SEARCH_X86
+__attribute__((target("avx2"))) static size_t
+_search_i32_avx2(int32_t* base, size_t n, int32_t key)
+{
+        // The array is sorted, so the lower bound is the number of elements
+        // smaller than the key.
+        __m256i k = _mm256_set1_epi32(key);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+                __m256i v = _mm256_loadu_si256((__m256i*)(base + i));
+                __m256i lt = _mm256_cmpgt_epi32(k, v);
+                count += __builtin_popcount(
+                    _mm256_movemask_ps(_mm256_castsi256_ps(lt)));
+        }
+        for (; i < n; ++i)
+        {
+                count += base[i] < key;
+        }
+        return count;
+}
+
+__attribute__((target("sse2"))) static size_t
+_search_i32_sse2(int32_t* base, size_t n, int32_t key)
+{
+        __m128i k = _mm_set1_epi32(key);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+                __m128i v = _mm_loadu_si128((__m128i*)(base + i));
+                __m128i lt = _mm_cmpgt_epi32(k, v);
+                count += __builtin_popcount(
+                    _mm_movemask_ps(_mm_castsi128_ps(lt)));
+        }
+        for (; i < n; ++i)
+        {
+                count += base[i] < key;
+        }
+        return count;
+}
+
+__attribute__((target("avx2"))) static size_t
+_search_i64_avx2(int64_t* base, size_t n, int64_t key)
+{
+        __m256i k = _mm256_set1_epi64x(key);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+                __m256i v = _mm256_loadu_si256((__m256i*)(base + i));
+                __m256i lt = _mm256_cmpgt_epi64(k, v);
+                count += __builtin_popcount(
+                    _mm256_movemask_pd(_mm256_castsi256_pd(lt)));
+        }
+        for (; i < n; ++i)
+        {
+                count += base[i] < key;
+        }
+        return count;
+}
+
+__attribute__((target("sse4.2"))) static size_t
+_search_i64_sse42(int64_t* base, size_t n, int64_t key)
+{
+        __m128i k = _mm_set1_epi64x(key);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+        {
+                __m128i v = _mm_loadu_si128((__m128i*)(base + i));
+                __m128i lt = _mm_cmpgt_epi64(k, v);
+                count += __builtin_popcount(
+                    _mm_movemask_pd(_mm_castsi128_pd(lt)));
+        }
+        for (; i < n; ++i)
+        {
+                count += base[i] < key;
+        }
+        return count;
+}
+#endif
+
+/**
+ * @brief Finds the lower bound of a 32 bit integer with SIMD comparisons.
+ *
+ * Compares the key to 8 (AVX2) or 4 (SSE2) elements at a time and counts the
+ * smaller ones, without branching on the result. The instruction set is
+ * chosen at runtime. Falls back to a scalar count on other architectures.
+ *
+ * @param base Pointer to the first element of the array.
+ * @param n Number of elements on the array.
+ * @param key Key to search for.
+ * @return Index of the first element not smaller than the key.
+ */
+size_t
+search_i32(int32_t* base, size_t n, int32_t key)
+{
+#ifdef _SEARCH_X86
+        if (__builtin_cpu_supports("avx2"))
+        {
+                return _search_i32_avx2(base, n, key);
+        }
+        return _search_i32_sse2(base, n, key);
+#else
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+                count += base[i] < key;
+        }
+        return count;
+#endif
+}
+
+/**
+ * @brief Finds the lower bound of a 64 bit integer with SIMD comparisons.
+ *
+ * Compares the key to 4 (AVX2) or 2 (SSE4.2) elements at a time and counts the
+ * smaller ones, without branching on the result. The instruction set is
+ * chosen at runtime, falling back to a scalar count when neither is
+ * available.
+ *
+ * @param base Pointer to the first element of the array.
+ * @param n Number of elements on the array.
+ * @param key Key to search for.
+ * @return Index of the first element not smaller than the key.
+ */
+size_t
+search_i64(int64_t* base, size_t n, int64_t key)
+{
+#ifdef _SEARCH_X86
+        if (__builtin_cpu_supports("avx2"))
+        {
+                return _search_i64_avx2(base, n, key);
+        }
+        if (__builtin_cpu_supports("sse4.2"))
+        {
+                return _search_i64_sse42(base, n, key);
+        }
+#endif
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+                count += base[i] < key;
+        }
+        return count;
+}
+
+/**
+ * @brief Finds the lower bound of a key with the fastest search available for
+ * the comparator.
+ *
+ * Uses @ref search_i32 or @ref search_i64 when the comparator is
+ * @ref search_cmp_i32 or @ref search_cmp_i64, and @ref search_binary
+ * otherwise.
+ *
+ * @param base Pointer to the first element of the array.
+ * @param n Number of elements on the array.
+ * @param el_size Size of each element.
+ * @param key Pointer to the key to search for.
+ * @param cmp Search comparator.
+ * @return Index of the first element not smaller than the key.
+ */
+size_t
+search_lower_bound(data* base, size_t n, size_t el_size, data* key,
+                   int (*cmp)(void*, void*))
+{
+        if (cmp == search_cmp_i32)
+        {
+                return search_i32(base, n, *(int32_t*)key);
+        }
+        if (cmp == search_cmp_i64)
+        {
+                return search_i64(base, n, *(int64_t*)key);
+        }
+        return search_binary(base, n, el_size, key, cmp);
+}
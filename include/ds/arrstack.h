@@ -31,6 +31,29 @@
 struct slice* arrstack_make(size_t el_size, size_t el_no)
     __attribute__((alias("slice_make")));
 
+/**
+ * @brief Initializes a stack on memory provided by the caller.
+ *
+ * Every call to arrstack_make_in **must** have a matching call to
+ * @ref arrstack_release.
+ * @see slice_make_in
+ *
+ * @param mem Memory for the stack and its first elements.
+ * @param size Size of `mem` in bytes.
+ * @param el_size Size of each element.
+ */
+struct slice* arrstack_make_in(data* mem, size_t size, size_t el_size)
+    __attribute__((alias("slice_make_in")));
+
+/**
+ * @brief Deallocates the memory managed by a stack created by
+ * @ref arrstack_make_in, if it outgrew the memory it was given.
+ * @see slice_release
+ *
+ * @param p Handle to the slice.
+ */
+void arrstack_release(struct slice* p) __attribute__((alias("slice_release")));
+
 /**
  * @brief Deallocates the memory managed by a stack created by
  * @ref arrstack_make
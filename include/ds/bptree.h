@@ -0,0 +1,761 @@
+#pragma once
+#pragma icanc include
+#include <leet.h>
+#include <alg/search.h>
+#pragma icanc end
+
+#include <stdint.h>
+
+/**
+ * @file bptree.h
+ *
+ * `#include <ds/bptree.h>`
+ *
+ * A [B+tree](https://en.wikipedia.org/wiki/B%2B_tree). Unlike a @ref btree,
+ * every entry lives on a leaf and internal nodes only hold keys to guide
+ * searches, so they fit more children per node. Each leaf links to the next
+ * one, which makes ordered scans a walk over consecutive leaves instead of a
+ * walk up and down the tree.
+ *
+ * Nodes are laid out like the ones of a @ref cbtree: a single
+ * cache-line-aligned block holding the header and the keys, followed by the
+ * values on leaves or the children on internal nodes. Leaves and internal
+ * nodes take the same number of cache lines, so each fits as many entries as
+ * it can.
+ *
+ * The API mirrors the @ref btree API, except that inserting a key that is
+ * already on the tree replaces its value.
+ */
+
+/**
+ * @brief Size of a cache line in bytes. Nodes are aligned to and sized in
+ * multiples of this.
+ */
+#define _BPTREE_CACHE_LINE 64
+
+/**
+ * @brief Number of cache lines per node on a tree created by
+ * @ref bptree_create.
+ * @see bptree_create_lines
+ */
+#define _BPTREE_LINES 4
+
+/**
+ * @brief A node in a B+tree.
+ *
+ * Only the header of the node is described by the struct. The keys are stored
+ * inline right after it, followed by the values or the children.
+ */
+struct bptree
+{
+        uint32_t _n;          ///< Number of keys on the node.
+        uint16_t _key_size;   ///< Size of each key in bytes.
+        uint16_t _val_size;   ///< Size of each value in bytes.
+        uint16_t _leaf_max;   ///< Maximum number of entries on a leaf.
+        uint16_t _inner_max;  ///< Maximum number of keys on an internal node.
+        bool _leaf;           ///< Whether the node has no children.
+        struct bptree* _next; ///< Next leaf in key order, on leaves only.
+};
+
+/**
+ * @brief Position on a bptree, for walking its entries in order.
+ *
+ * A cursor is invalidated by any change to the tree.
+ * @see bptree_seek
+ */
+struct bptree_cursor
+{
+        /// @privatesection
+        struct bptree* _leaf; ///< Leaf under the cursor, null past the end.
+        size_t _idx;          ///< Entry under the cursor.
+};
+
+static size_t _bptree_values(struct bptree* p);
+static struct bptree* _bptree_node(struct bptree* like, bool leaf);
+static bool _bptree_insert(struct bptree* p, void* key, void* value,
+                           int (*cmp)(void*, void*), void* up_key,
+                           struct bptree** up_node);
+static bool _bptree_remove(struct bptree* p, void* key,
+                           int (*cmp)(void*, void*));
+static void _bptree_rebalance(struct bptree* p, size_t i);
+
+/**
+ * @brief Initializes a bptree whose nodes span a given number of cache lines.
+ *
+ * Picks how many entries fit on a leaf and how many keys and children fit on
+ * an internal node of `lines` cache lines. Nodes hold at least 3 keys, so
+ * large keys **may** overflow small nodes.
+ *
+ * Every call to bptree_create_lines **must** have a matching call to
+ * @ref bptree_destroy to release the managed memory.
+ *
+ * @param key_size Size of each key.
+ * @param val_size Size of each value.
+ * @param lines Number of cache lines per node.
+ * @return Handle to the bptree.
+ */
+struct bptree*
+bptree_create_lines(size_t key_size, size_t val_size, size_t lines)
+{
+        size_t bytes = lines * _BPTREE_CACHE_LINE - sizeof(struct bptree);
+        size_t leaf_max = bytes / (key_size + val_size);
+        size_t inner_max = (bytes - sizeof(struct bptree*))
+                           / (key_size + sizeof(struct bptree*));
+        assert(key_size <= UINT16_MAX && val_size <= UINT16_MAX);
+
+        struct bptree like = {
+                ._key_size = key_size,
+                ._val_size = val_size,
+                ._leaf_max = max(leaf_max, 3),
+                ._inner_max = max(inner_max, 3),
+        };
+        // The values are aligned after the keys, and the padding may take
+        // the room of an entry.
+        while (like._leaf_max > 3
+               && _bptree_values(&like) + like._leaf_max * val_size
+                      > lines * _BPTREE_CACHE_LINE)
+        {
+                --like._leaf_max;
+        }
+        return _bptree_node(&like, true);
+}
+
+/**
+ * @brief Initializes a bptree.
+ *
+ * Every call to bptree_create **must** have a matching call to
+ * @ref bptree_destroy to release the managed memory.
+ *
+ * @param key_size Size of each key.
+ * @param val_size Size of each value.
+ * @return Handle to the bptree.
+ */
+struct bptree*
+bptree_create(size_t key_size, size_t val_size)
+{
+        return bptree_create_lines(key_size, val_size, _BPTREE_LINES);
+}
+
+static inline byte*
+_bptree_key(struct bptree* p, size_t idx)
+{
+        return (byte*)p + sizeof(struct bptree) + idx * p->_key_size;
+}
+
+static inline size_t
+_bptree_align(size_t size)
+{
+        // Rounds up to the alignment of size_t, so values and children can
+        // be read in place.
+        return (size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+}
+
+static inline size_t
+_bptree_values(struct bptree* p)
+{
+        // Offset of the values on a leaf.
+        return _bptree_align(sizeof(struct bptree)
+                             + p->_leaf_max * p->_key_size);
+}
+
+static inline size_t
+_bptree_children(struct bptree* p)
+{
+        // Offset of the children on an internal node.
+        return _bptree_align(sizeof(struct bptree)
+                             + p->_inner_max * p->_key_size);
+}
+
+static inline byte*
+_bptree_val(struct bptree* p, size_t idx)
+{
+        return (byte*)p + _bptree_values(p) + idx * p->_val_size;
+}
+
+static inline struct bptree**
+_bptree_child(struct bptree* p, size_t idx)
+{
+        return (struct bptree**)((byte*)p + _bptree_children(p)) + idx;
+}
+
+static inline size_t
+_bptree_find(struct bptree* p, void* key, int (*cmp)(void*, void*))
+{
+        return search_lower_bound(_bptree_key(p, 0), p->_n, p->_key_size, key,
+                                  cmp);
+}
+
+static inline size_t
+_bptree_route(struct bptree* p, void* key, int (*cmp)(void*, void*))
+{
+        // Separators are the first key of their right subtree, so keys equal
+        // to one go right.
+        size_t i = _bptree_find(p, key, cmp);
+        return i + (i < p->_n && cmp(key, _bptree_key(p, i)) == 0);
+}
+
+static inline size_t
+_bptree_min(struct bptree* p)
+{
+        // A full node splits in two halves of at least this many keys, and
+        // two nodes that fall under it always fit on one when merged.
+        return p->_leaf ? p->_leaf_max / 2 : (p->_inner_max - 1) / 2;
+}
+
+/**
+ * @brief Deallocates the memory managed by a bptree created with
+ * @ref bptree_create.
+ *
+ * Releases every node on the tree.
+ *
+ * @param p Handle to the bptree.
+ */
+void
+bptree_destroy(struct bptree* p)
+{
+        if (!p->_leaf)
+        {
+                for (size_t i = 0; i <= p->_n; ++i)
+                {
+                        bptree_destroy(*_bptree_child(p, i));
+                }
+        }
+        free(p);
+}
+
+/**
+ * @brief Inserts an entry into the tree.
+ *
+ * Finds the appropriate position and inserts the key-value pair while
+ * preserving the B+tree properties. If the key is already on the tree, its
+ * value is replaced instead. The comparator receives a pointer to the given
+ * key, and a pointer to the key being compared, respectively.
+ * **May** update the root pointer.
+ *
+ * @param p Handle to the root of the tree.
+ * @param key Handle to the key to insert.
+ * @param value Handle to the value to insert.
+ * @param cmp Insertion comparator.
+ */
+void
+bptree_insert(struct bptree** p, void* key, void* value,
+              int (*cmp)(void*, void*))
+{
+        struct bptree* x = *p;
+        byte up_key[x->_key_size];
+        struct bptree* up_node;
+
+        if (_bptree_insert(x, key, value, cmp, up_key, &up_node))
+        {
+                // The root split, grow the tree by one level.
+                struct bptree* root = _bptree_node(x, false);
+                memcpy(_bptree_key(root, 0), up_key, x->_key_size);
+                *_bptree_child(root, 0) = x;
+                *_bptree_child(root, 1) = up_node;
+                root->_n = 1;
+                *p = root;
+        }
+}
+
+/**
+ * @brief Finds a key on the tree and returns a handle to its value, if it
+ * exists.
+ *
+ * Finds the value associated with the given key, if it exists. Returns null
+ * otherwise. The comparator receives a pointer to the given key, and a pointer
+ * to the key being compared, respectively.
+ *
+ * @param p Handle to the tree.
+ * @param key Handle to the key to search for.
+ * @param cmp Search comparator.
+ */
+data*
+bptree_search(struct bptree* p, void* key, int (*cmp)(void*, void*))
+{
+        while (!p->_leaf)
+        {
+                p = *_bptree_child(p, _bptree_route(p, key, cmp));
+        }
+
+        size_t i = _bptree_find(p, key, cmp);
+        if (i < p->_n && cmp(key, _bptree_key(p, i)) == 0)
+        {
+                return _bptree_val(p, i);
+        }
+        return NULL;
+}
+
+/**
+ * @brief Finds and deletes an entry from the tree.
+ *
+ * Deletes the given key and its associated value from the tree, if it exists.
+ * Does not change the tree if the key doesn't exist. The comparator receives a
+ * pointer to the given key, and a pointer to the key being compared,
+ * respectively.
+ * **May** update the root pointer.
+ *
+ * @param p Handle to the root of the tree.
+ * @param key Handle to the key to delete.
+ * @param cmp Deletion comparator.
+ * @return Whether or not the value was on the original tree.
+ */
+bool
+bptree_remove(struct bptree** p, void* key, int (*cmp)(void*, void*))
+{
+        struct bptree* x = *p;
+        bool removed = _bptree_remove(x, key, cmp);
+
+        if (!x->_leaf && x->_n == 0)
+        {
+                // The root lost its last key to a merge, shrink the tree by
+                // one level.
+                *p = *_bptree_child(x, 0);
+                free(x);
+        }
+        return removed;
+}
+
+/**
+ * @brief Moves a cursor to the first entry whose key is not smaller than the
+ * given key.
+ *
+ * Positions the cursor on the given key if it is on the tree, or on the entry
+ * that would come right after it otherwise. A null key positions the cursor
+ * on the first entry of the tree. The comparator receives a pointer to the
+ * given key, and a pointer to the key being compared, respectively.
+ *
+ * @param c Cursor to position.
+ * @param p Handle to the tree.
+ * @param key Handle to the key to seek, **may** be null.
+ * @param cmp Search comparator.
+ * @return Whether or not the cursor is on an entry.
+ */
+bool
+bptree_seek(struct bptree_cursor* c, struct bptree* p, void* key,
+            int (*cmp)(void*, void*))
+{
+        while (!p->_leaf)
+        {
+                size_t i = key == NULL ? 0 : _bptree_route(p, key, cmp);
+                p = *_bptree_child(p, i);
+        }
+
+        c->_leaf = p;
+        c->_idx = key == NULL ? 0 : _bptree_find(p, key, cmp);
+        if (c->_idx == p->_n)
+        {
+                // Every key on the leaf is smaller, or the tree is empty.
+                c->_leaf = p->_next;
+                c->_idx = 0;
+        }
+        return c->_leaf != NULL;
+}
+
+/**
+ * @brief Moves a cursor to the next entry, in key order.
+ *
+ * Leaves are only linked forwards, so there is no way back.
+ *
+ * @param c Cursor on an entry.
+ * @return Whether or not the cursor is on an entry. False if it moved past
+ * the last entry.
+ */
+bool
+bptree_next(struct bptree_cursor* c)
+{
+        if (++c->_idx == c->_leaf->_n)
+        {
+                c->_leaf = c->_leaf->_next;
+                c->_idx = 0;
+        }
+        return c->_leaf != NULL;
+}
+
+/**
+ * @brief Returns a handle to the key under a cursor.
+ *
+ * @param c Cursor on an entry.
+ */
+data*
+bptree_cursor_key(struct bptree_cursor* c)
+{
+        return _bptree_key(c->_leaf, c->_idx);
+}
+
+/**
+ * @brief Returns a handle to the value under a cursor.
+ *
+ * @param c Cursor on an entry.
+ */
+data*
+bptree_cursor_value(struct bptree_cursor* c)
+{
+        return _bptree_val(c->_leaf, c->_idx);
+}
+
+/**
+ * @brief Calls a function on every entry with a key between two bounds, in
+ * key order.
+ *
+ * Visits the entries whose keys are in `[lo, hi]`. A null bound leaves that
+ * side of the range open. The callback receives a pointer to the key, a
+ * pointer to the value and the given context, respectively, and **must not**
+ * change the tree.
+ *
+ * @param p Handle to the tree.
+ * @param lo Handle to the smallest key to visit, **may** be null.
+ * @param hi Handle to the largest key to visit, **may** be null.
+ * @param cmp Search comparator.
+ * @param callback Function to call on each entry.
+ * @param ctx Passed to the callback as is.
+ * @return Number of entries visited.
+ */
+size_t
+bptree_range(struct bptree* p, void* lo, void* hi, int (*cmp)(void*, void*),
+             void (*callback)(data* key, data* value, data* ctx), data* ctx)
+{
+        struct bptree_cursor c;
+        size_t n = 0;
+
+        for (bool ok = bptree_seek(&c, p, lo, cmp); ok; ok = bptree_next(&c))
+        {
+                data* key = bptree_cursor_key(&c);
+                if (hi != NULL && cmp(key, hi) > 0)
+                {
+                        break;
+                }
+                callback(key, bptree_cursor_value(&c), ctx);
+                ++n;
+        }
+
+        return n;
+}
+
+static struct bptree*
+_bptree_node(struct bptree* like, bool leaf)
+{
+        // Copies the shape of the tree from another node.
+        size_t size = leaf ? _bptree_values(like)
+                                 + like->_leaf_max * like->_val_size
+                           : _bptree_children(like)
+                                 + (like->_inner_max + 1)
+                                       * sizeof(struct bptree*);
+        size = (size + _BPTREE_CACHE_LINE - 1) & ~(_BPTREE_CACHE_LINE - 1);
+
+        void* node;
+        if (posix_memalign(&node, _BPTREE_CACHE_LINE, size) != 0)
+        {
+                return NULL;
+        }
+        struct bptree* p = node;
+
+        p->_n = 0;
+        p->_key_size = like->_key_size;
+        p->_val_size = like->_val_size;
+        p->_leaf_max = like->_leaf_max;
+        p->_inner_max = like->_inner_max;
+        p->_leaf = leaf;
+        p->_next = NULL;
+
+        return p;
+}
+
+static void
+_bptree_insert_at(struct bptree* p, size_t i, void* key, void* body)
+{
+        // Inserts a key and either a value (leaves) or the child to its right
+        // (internal nodes). Invariant: p is not full.
+        size_t key_size = p->_key_size;
+        memmove(_bptree_key(p, i + 1), _bptree_key(p, i),
+                (p->_n - i) * key_size);
+        memcpy(_bptree_key(p, i), key, key_size);
+
+        if (p->_leaf)
+        {
+                memmove(_bptree_val(p, i + 1), _bptree_val(p, i),
+                        (p->_n - i) * p->_val_size);
+                memcpy(_bptree_val(p, i), body, p->_val_size);
+        }
+        else
+        {
+                memmove(_bptree_child(p, i + 2), _bptree_child(p, i + 1),
+                        (p->_n - i) * sizeof(struct bptree*));
+                *_bptree_child(p, i + 1) = body;
+        }
+        ++p->_n;
+}
+
+static bool
+_bptree_insert(struct bptree* p, void* key, void* value,
+               int (*cmp)(void*, void*), void* up_key,
+               struct bptree** up_node)
+{
+        size_t key_size = p->_key_size;
+        size_t i;
+        void* body;
+
+        if (p->_leaf)
+        {
+                i = _bptree_find(p, key, cmp);
+                if (i < p->_n && cmp(key, _bptree_key(p, i)) == 0)
+                {
+                        memcpy(_bptree_val(p, i), value, p->_val_size);
+                        return false;
+                }
+                body = value;
+        }
+        else
+        {
+                i = _bptree_route(p, key, cmp);
+                byte child_key[key_size];
+                struct bptree* child_node;
+                if (!_bptree_insert(*_bptree_child(p, i), key, value, cmp,
+                                    child_key, &child_node))
+                {
+                        return false;
+                }
+                // The child split, its separator and new sibling go here.
+                // up_key is free until this node splits, so keep the key
+                // there.
+                memcpy(up_key, child_key, key_size);
+                key = up_key;
+                body = child_node;
+        }
+
+        size_t full = p->_leaf ? p->_leaf_max : p->_inner_max;
+        if (p->_n < full)
+        {
+                _bptree_insert_at(p, i, key, body);
+                return false;
+        }
+
+        // Split the node in two halves, then insert into the one the entry
+        // belongs to.
+        struct bptree* right = _bptree_node(p, p->_leaf);
+        size_t mid = full / 2;
+        byte sep[key_size];
+
+        if (p->_leaf)
+        {
+                // The separator is copied up, it stays as the first key of
+                // the right leaf.
+                right->_n = full - mid;
+                memcpy(_bptree_key(right, 0), _bptree_key(p, mid),
+                       right->_n * key_size);
+                memcpy(_bptree_val(right, 0), _bptree_val(p, mid),
+                       right->_n * p->_val_size);
+                memcpy(sep, _bptree_key(p, mid), key_size);
+                right->_next = p->_next;
+                p->_next = right;
+                p->_n = mid;
+
+                // A key that lands between the halves goes left, it is
+                // smaller than the separator.
+                if (i <= mid)
+                {
+                        _bptree_insert_at(p, i, key, body);
+                }
+                else
+                {
+                        _bptree_insert_at(right, i - mid, key, body);
+                }
+        }
+        else
+        {
+                // The separator is moved up, along with the middle key.
+                right->_n = full - mid - 1;
+                memcpy(_bptree_key(right, 0), _bptree_key(p, mid + 1),
+                       right->_n * key_size);
+                memcpy(_bptree_child(right, 0), _bptree_child(p, mid + 1),
+                       (right->_n + 1) * sizeof(struct bptree*));
+                memcpy(sep, _bptree_key(p, mid), key_size);
+                p->_n = mid;
+
+                if (i <= mid)
+                {
+                        _bptree_insert_at(p, i, key, body);
+                }
+                else
+                {
+                        _bptree_insert_at(right, i - mid - 1, key, body);
+                }
+        }
+
+        memcpy(up_key, sep, key_size);
+        *up_node = right;
+        return true;
+}
+
+static bool
+_bptree_remove(struct bptree* p, void* key, int (*cmp)(void*, void*))
+{
+        if (p->_leaf)
+        {
+                size_t i = _bptree_find(p, key, cmp);
+                if (i == p->_n || cmp(key, _bptree_key(p, i)) != 0)
+                {
+                        return false;
+                }
+                memmove(_bptree_key(p, i), _bptree_key(p, i + 1),
+                        (p->_n - i - 1) * p->_key_size);
+                memmove(_bptree_val(p, i), _bptree_val(p, i + 1),
+                        (p->_n - i - 1) * p->_val_size);
+                --p->_n;
+                return true;
+        }
+
+        // Separators are left as they are, a key that is no longer on the
+        // tree still tells its subtrees apart.
+        size_t i = _bptree_route(p, key, cmp);
+        if (!_bptree_remove(*_bptree_child(p, i), key, cmp))
+        {
+                return false;
+        }
+        if ((*_bptree_child(p, i))->_n < _bptree_min(*_bptree_child(p, i)))
+        {
+                _bptree_rebalance(p, i);
+        }
+        return true;
+}
+
+static void
+_bptree_remove_at(struct bptree* p, size_t i)
+{
+        // Removes key i and the child to its right from an internal node.
+        memmove(_bptree_key(p, i), _bptree_key(p, i + 1),
+                (p->_n - i - 1) * p->_key_size);
+        memmove(_bptree_child(p, i + 1), _bptree_child(p, i + 2),
+                (p->_n - i - 1) * sizeof(struct bptree*));
+        --p->_n;
+}
+
+static void
+_bptree_merge(struct bptree* p, size_t i)
+{
+        // Merges child i + 1 into child i.
+        struct bptree* left = *_bptree_child(p, i);
+        struct bptree* right = *_bptree_child(p, i + 1);
+        size_t key_size = p->_key_size;
+
+        if (left->_leaf)
+        {
+                memcpy(_bptree_key(left, left->_n), _bptree_key(right, 0),
+                       right->_n * key_size);
+                memcpy(_bptree_val(left, left->_n), _bptree_val(right, 0),
+                       right->_n * left->_val_size);
+                left->_n += right->_n;
+                left->_next = right->_next;
+        }
+        else
+        {
+                // Internal nodes pull the separator down between the two.
+                memcpy(_bptree_key(left, left->_n), _bptree_key(p, i),
+                       key_size);
+                memcpy(_bptree_key(left, left->_n + 1), _bptree_key(right, 0),
+                       right->_n * key_size);
+                memcpy(_bptree_child(left, left->_n + 1),
+                       _bptree_child(right, 0),
+                       (right->_n + 1) * sizeof(struct bptree*));
+                left->_n += right->_n + 1;
+        }
+
+        free(right);
+        _bptree_remove_at(p, i);
+}
+
+static void
+_bptree_steal_prev(struct bptree* p, size_t i)
+{
+        struct bptree* curr = *_bptree_child(p, i);
+        struct bptree* prev = *_bptree_child(p, i - 1);
+        size_t key_size = p->_key_size;
+
+        memmove(_bptree_key(curr, 1), _bptree_key(curr, 0),
+                curr->_n * key_size);
+        if (curr->_leaf)
+        {
+                // Move the last entry over, it becomes the new separator.
+                memmove(_bptree_val(curr, 1), _bptree_val(curr, 0),
+                        curr->_n * curr->_val_size);
+                memcpy(_bptree_key(curr, 0), _bptree_key(prev, prev->_n - 1),
+                       key_size);
+                memcpy(_bptree_val(curr, 0), _bptree_val(prev, prev->_n - 1),
+                       curr->_val_size);
+                memcpy(_bptree_key(p, i - 1), _bptree_key(curr, 0), key_size);
+        }
+        else
+        {
+                // Rotate the last key through the parent.
+                memmove(_bptree_child(curr, 1), _bptree_child(curr, 0),
+                        (curr->_n + 1) * sizeof(struct bptree*));
+                memcpy(_bptree_key(curr, 0), _bptree_key(p, i - 1), key_size);
+                *_bptree_child(curr, 0) = *_bptree_child(prev, prev->_n);
+                memcpy(_bptree_key(p, i - 1), _bptree_key(prev, prev->_n - 1),
+                       key_size);
+        }
+        ++curr->_n;
+        --prev->_n;
+}
+
+static void
+_bptree_steal_next(struct bptree* p, size_t i)
+{
+        struct bptree* curr = *_bptree_child(p, i);
+        struct bptree* next = *_bptree_child(p, i + 1);
+        size_t key_size = p->_key_size;
+
+        if (curr->_leaf)
+        {
+                // Move the first entry over, the one after it becomes the new
+                // separator.
+                memcpy(_bptree_key(curr, curr->_n), _bptree_key(next, 0),
+                       key_size);
+                memcpy(_bptree_val(curr, curr->_n), _bptree_val(next, 0),
+                       curr->_val_size);
+                memmove(_bptree_val(next, 0), _bptree_val(next, 1),
+                        (next->_n - 1) * next->_val_size);
+                memmove(_bptree_key(next, 0), _bptree_key(next, 1),
+                        (next->_n - 1) * key_size);
+                memcpy(_bptree_key(p, i), _bptree_key(next, 0), key_size);
+        }
+        else
+        {
+                // Rotate the first key through the parent.
+                memcpy(_bptree_key(curr, curr->_n), _bptree_key(p, i),
+                       key_size);
+                *_bptree_child(curr, curr->_n + 1) = *_bptree_child(next, 0);
+                memcpy(_bptree_key(p, i), _bptree_key(next, 0), key_size);
+                memmove(_bptree_key(next, 0), _bptree_key(next, 1),
+                        (next->_n - 1) * key_size);
+                memmove(_bptree_child(next, 0), _bptree_child(next, 1),
+                        next->_n * sizeof(struct bptree*));
+        }
+        ++curr->_n;
+        --next->_n;
+}
+
+static void
+_bptree_rebalance(struct bptree* p, size_t i)
+{
+        // Child i is under the minimum. Borrow from a sibling that can spare
+        // a key, or merge with one that can't.
+        if (i > 0)
+        {
+                struct bptree* prev = *_bptree_child(p, i - 1);
+                if (prev->_n > _bptree_min(prev))
+                {
+                        _bptree_steal_prev(p, i);
+                        return;
+                }
+        }
+        if (i < p->_n)
+        {
+                struct bptree* next = *_bptree_child(p, i + 1);
+                if (next->_n > _bptree_min(next))
+                {
+                        _bptree_steal_next(p, i);
+                        return;
+                }
+        }
+        _bptree_merge(p, i > 0 ? i - 1 : i);
+}
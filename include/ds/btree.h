@@ -1,17 +1,27 @@
 #pragma once
 #pragma icanc include
 #include <leet.h>
+#include <alg/search.h>
+#include <alg/sort.h>
 #include <ds/slice.h>
 #pragma icanc end
 
-#define _btree_block_size 128
-
 /**
  * @file btree.h
  *
  * `include <ds/btree.h>`
  */
 
+/**
+ * @brief Size in bytes of the largest array on a node created by
+ * @ref btree_create.
+ *
+ * The degree of the tree is chosen so that the keys, values and children of a
+ * node each fit in a block of this size.
+ * @see btree_create_block
+ */
+#define _btree_block_size 128
+
 /**
  * @brief A node in an in-memory
  * [B-tree](https://en.wikipedia.org/wiki/B-tree).
@@ -32,25 +42,151 @@ struct _btree
         /// @privatesection
         size_t t; ///< Degree of the tree.
                   ///< How many elements fit on the btree block.
+        struct btree_pool* pool; ///< Pool the node came from, or null.
+        size_t refs; ///< Roots and parents pointing to the node, more than 1
+                     ///< when it is shared with a snapshot.
+        size_t splits; ///< Children split under the node, plus the splits
+                       ///< of the nodes merged into it.
+        size_t merges; ///< Children merged under the node, plus the merges
+                       ///< of the nodes merged into it.
+};
+
+/**
+ * @brief Number of nodes a @ref btree_pool allocates at once.
+ */
+#define _btree_pool_nodes 64
+
+/**
+ * @brief Fixed-size node allocator for btrees.
+ *
+ * Hands out node blocks from chunks of @ref _btree_pool_nodes nodes and keeps
+ * the nodes released by merges on a free list for the next split. Every tree
+ * on a pool **must** have the key and value sizes the pool was created with.
+ * @see btree_pool_create
+ */
+struct btree_pool
+{
+        /// @privatesection
+        size_t _key_size;      ///< Size of each key.
+        size_t _val_size;      ///< Size of each value.
+        size_t _t;             ///< Degree of the trees on the pool.
+        size_t _node_size;     ///< Size of each node block in bytes.
+        struct slice* _chunks; ///< Every chunk the pool allocated.
+        size_t _chunk;         ///< Chunk nodes are being carved from.
+        size_t _used;          ///< Nodes carved from the current chunk.
+        void* _free;           ///< Released nodes, linked through their
+                               ///< first word.
+};
+
+/**
+ * @brief Maximum height of a tree a @ref btree_cursor can walk.
+ *
+ * Every node but the root has at least two children, so a tree of this
+ * height holds more entries than fit in memory.
+ */
+#define _btree_max_height 64
+
+/**
+ * @brief Position on a btree, for walking its entries in order.
+ *
+ * Holds the path from the root to the current entry, so moving to the next
+ * or previous entry needs neither recursion nor allocation. A cursor is
+ * invalidated by any change to the tree.
+ * @see btree_seek
+ */
+struct btree_cursor
+{
+        /// @privatesection
+        struct btree* _nodes[_btree_max_height]; ///< Path from the root.
+        size_t _idx[_btree_max_height]; ///< Key on the last node, child taken
+                                        ///< on the others.
+        size_t _depth; ///< Length of the path, 0 past either end.
+};
+
+/**
+ * @brief Shape and memory usage of a btree.
+ * @see btree_stats
+ */
+struct btree_stats
+{
+        size_t height;  ///< Number of levels, 1 for a lone root.
+        size_t nodes;   ///< Number of nodes.
+        size_t entries; ///< Number of key-value pairs.
+        size_t level_nodes[_btree_max_height]; ///< Nodes on each level, from
+                                               ///< the root down.
+        double fill;     ///< Average keys per node, over the maximum.
+        size_t bytes;    ///< Bytes allocated for nodes, headers included.
+        size_t capacity; ///< Bytes allocated for keys, values and children.
+        size_t used;     ///< Bytes of capacity holding keys, values and
+                         ///< children.
+        size_t splits;   ///< Nodes split since the tree was created.
+        size_t merges;   ///< Nodes merged since the tree was created.
 };
 
 static bool leaf(struct btree* p);
 static size_t keyno(struct btree* p);
+static size_t childno(struct btree* p);
 static size_t find_key(struct btree* p, data* key, int (*cmp)(data*, data*));
+static size_t find_match(struct btree* p, data* key, int (*cmp)(data*, data*),
+                         bool* found);
+static struct data* key_at(struct btree* p, size_t idx);
+static struct data* val_at(struct btree* p, size_t idx);
 static struct btree** child_at(struct btree* p, size_t idx);
 
+static size_t block_degree(size_t key_size, size_t val_size,
+                           size_t block_size);
 static struct btree* btree_create_t(size_t key_size, size_t val_size,
                                     size_t t);
-
+static size_t word_align(size_t size);
+static size_t node_size(size_t key_size, size_t val_size, size_t t);
+static struct btree* node_make(size_t key_size, size_t val_size, size_t t,
+                               struct btree_pool* pool);
+static void node_del(struct btree* p);
+static struct btree* node_own(struct btree** p);
+
+static bool cursor_down(struct btree_cursor* c, struct btree* p,
+                        bool rightmost);
+static bool cursor_up(struct btree_cursor* c, bool backwards);
+
+static void stats_walk(struct btree* p, size_t depth, struct btree_stats* s);
+
+static struct slice* batch_sort(data* keys, data* values, size_t n,
+                                size_t key_size, size_t val_offset,
+                                size_t val_size, int (*cmp)(void*, void*));
+static struct btree* insert_bounded(struct btree** p, void* key, void* value,
+                                    int (*cmp)(void*, void*), byte* lo,
+                                    byte* hi, bool* has_lo, bool* has_hi);
+static void search_group(struct btree* p, struct slice* batch, size_t first,
+                         size_t n, size_t* pos, data** values,
+                         int (*cmp)(data*, data*));
+
+static void split_child(struct btree* p, size_t i);
 static void split_root(struct btree** p);
 static void insert_non_full(struct btree* p, void* key, void* value,
                             int (*cmp)(void*, void*));
 
-static bool delete_from_leaf(struct btree* x, size_t i);
-static bool delete_from_internal(struct btree** x, data* key, size_t i,
-                                 int (*cmp)(void*, void*));
-static bool delete_from_subtree(struct btree** parent, void* key, size_t i,
-                                int (*cmp)(void*, void*));
+static struct btree** merge(struct btree** root, size_t idx);
+static struct btree** refill_child(struct btree** parent, size_t i);
+
+/**
+ * @brief Initializes a btree whose nodes are sized for a given block size.
+ *
+ * Like @ref btree_create but picks the degree so that the keys, values and
+ * children of a node each fit in `block_size` bytes. The degree is never
+ * smaller than 2, so large keys **may** overflow small blocks. The
+ * `bench.ds.btree` benchmark compares block sizes across key sizes.
+ *
+ * @param key_size Size of each key.
+ * @param val_size Size of each value.
+ * @param block_size Size of the largest array on a node, in bytes.
+ * @return Handle to the btree.
+ */
+struct btree*
+btree_create_block(size_t key_size, size_t val_size, size_t block_size)
+{
+        size_t t = block_degree(key_size, val_size, block_size);
+        return btree_create_t(key_size, val_size, t);
+}
 
 /**
  * @brief Initializes a btree.
@@ -65,42 +201,425 @@ static bool delete_from_subtree(struct btree** parent, void* key, size_t i,
 struct btree*
 btree_create(size_t key_size, size_t val_size)
 {
-        // TODO Benchmark this.
+        return btree_create_block(key_size, val_size, _btree_block_size);
+}
+
+/**
+ * @brief Builds a btree from sorted entries.
+ *
+ * Builds the tree bottom-up in O(n) instead of inserting one entry at a time:
+ * the entries are packed into leaves in order, every entry between two leaves
+ * becomes a separator on the level above, and the separators are packed into
+ * internal nodes the same way until a single root is left. Nodes are filled
+ * to roughly `fill_factor` of their capacity, within the bounds of a B-tree,
+ * so a tree that will only be searched **should** be loaded with a fill
+ * factor of 1, and one that will keep growing with less to avoid splitting
+ * every node on the next inserts.
+ *
+ * The keys **must** be sorted in ascending order and **must not** repeat.
+ * Every call to btree_bulk_load **must** have a matching call to
+ * @ref btree_destroy to release the managed memory.
+ *
+ * @param keys Pointer to the first of `n` sorted keys.
+ * @param values Pointer to the first of `n` values, in the order of the keys.
+ * @param n Number of entries.
+ * @param key_size Size of each key.
+ * @param val_size Size of each value.
+ * @param fill_factor Fraction of each node to fill, between 0 and 1.
+ * @return Handle to the btree.
+ */
+struct btree*
+btree_bulk_load(data* keys, data* values, size_t n, size_t key_size,
+                size_t val_size, double fill_factor)
+{
+        size_t t = block_degree(key_size, val_size, _btree_block_size);
+        if (n == 0)
+        {
+                return btree_create_t(key_size, val_size, t);
+        }
+
+        // Every node is sized by its fanout f: a leaf with f - 1 keys or an
+        // internal node with f children and f - 1 keys, t <= f <= 2t. A level
+        // of nodes covering c slots (n + 1 for the leaves, the number of
+        // nodes below otherwise) uses c - 1 entries: f - 1 per node and one
+        // separator between each node.
+        size_t target = fill_factor * 2 * t + 0.5;
+        target = max(target, t);
+        target = target > 2 * t ? 2 * t : target;
+
+        size_t slots = n + 1;
+        struct btree** nodes = NULL;
+        // Indexes of the entries between the nodes of the current level.
+        size_t* separators = NULL;
+        bool leaves = true;
+
+        do
+        {
+                // As few nodes as fit the target, but never so few that a
+                // node would overflow.
+                size_t count = max(slots / target, 1);
+                count = max(count, (slots + 2 * t - 1) / (2 * t));
+                size_t fanout = slots / count;
+                size_t extra = slots % count;
+
+                struct btree** level = malloc(count * sizeof(struct btree*));
+                size_t* uppers = malloc(count * sizeof(size_t));
+                size_t entry = 0;
+                size_t child = 0;
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                        size_t f = fanout + (i < extra);
+                        struct btree* node
+                            = btree_create_t(key_size, val_size, t);
+
+                        if (leaves)
+                        {
+                                memcpy(node->keys->data,
+                                       (byte*)keys + entry * key_size,
+                                       (f - 1) * key_size);
+                                memcpy(node->values->data,
+                                       (byte*)values + entry * val_size,
+                                       (f - 1) * val_size);
+                                entry += f - 1;
+                        }
+                        else
+                        {
+                                for (size_t k = 0; k < f - 1; ++k)
+                                {
+                                        size_t sep = separators[entry++];
+                                        memcpy(slice_at(node->keys, k),
+                                               (byte*)keys + sep * key_size,
+                                               key_size);
+                                        memcpy(slice_at(node->values, k),
+                                               (byte*)values + sep * val_size,
+                                               val_size);
+                                }
+                                memcpy(node->children->data, nodes + child,
+                                       f * sizeof(struct btree*));
+                                node->children->len = f;
+                                child += f;
+                        }
+                        node->keys->len = f - 1;
+                        node->values->len = f - 1;
+
+                        // The entry after the node separates it from the
+                        // next one.
+                        if (i + 1 < count)
+                        {
+                                uppers[i] = leaves ? entry : separators[entry];
+                                ++entry;
+                        }
+                        level[i] = node;
+                }
+
+                free(nodes);
+                free(separators);
+                nodes = level;
+                separators = uppers;
+                slots = count;
+                leaves = false;
+        } while (slots > 1);
+
+        struct btree* root = nodes[0];
+        free(nodes);
+        free(separators);
+
+        return root;
+}
+
+static size_t
+block_degree(size_t key_size, size_t val_size, size_t block_size)
+{
         size_t max_data_size
             = max(key_size, max(val_size, sizeof(struct btree*)));
-        size_t t = _btree_block_size / (max_data_size * 2);
-
-        return btree_create_t(key_size, val_size, t);
+        return max(block_size / (max_data_size * 2), 2);
 }
 
 static struct btree*
 btree_create_t(size_t key_size, size_t val_size, size_t t)
 {
-        struct _btree* h = malloc(sizeof(struct _btree));
-
-        h->t = t;
-
-        h->keys = slice_make(key_size, 2 * h->t - 1);
-        h->values = slice_make(val_size, 2 * h->t - 1);
-        h->children = slice_make(sizeof(struct btree*), 2 * h->t);
-
-        return (struct btree*)h;
+        return node_make(key_size, val_size, t, NULL);
 }
 
 /**
  * @brief Deallocates the memory managed by a B-tree created with
- * @ref btree_create.
+ * @ref btree_create or @ref btree_snapshot.
  *
+ * Releases every node on the tree that is not shared with another snapshot.
  *
  * @param p Handle to the B-tree.
  */
 void
 btree_destroy(struct btree* p)
 {
-        slice_del(p->keys);
-        slice_del(p->values);
-        slice_del(p->children);
-        free(p);
+        struct _btree* h = (struct _btree*)p;
+        if (__atomic_sub_fetch(&h->refs, 1, __ATOMIC_ACQ_REL) > 0)
+        {
+                return;
+        }
+
+        for (size_t i = 0; i < p->children->len; ++i)
+        {
+                btree_destroy(((struct btree**)p->children->data)[i]);
+        }
+        node_del(p);
+}
+
+/**
+ * @brief Takes a snapshot of the tree.
+ *
+ * Returns a handle to a tree with the same entries as the given one, which
+ * does not change when the original does, and vice versa. Runs in constant
+ * time: both trees share every node, and from then on a change to either tree
+ * copies the nodes on its path from the root instead of changing them in
+ * place, so each change copies O(log n) nodes at most. Nodes are reference
+ * counted, and released once no tree uses them. Every call to btree_snapshot
+ * **must** have a matching call to @ref btree_destroy.
+ *
+ * Cursors on a snapshot stay valid while the original changes. A snapshot
+ * **may** be read on another thread while the original changes, e.g. to
+ * serialize it in the background, and destroyed there too unless the tree is
+ * on a @ref btree_pool.
+ *
+ * @param p Handle to the B-tree.
+ * @return Handle to the snapshot.
+ */
+struct btree*
+btree_snapshot(struct btree* p)
+{
+        struct _btree* h = (struct _btree*)p;
+        __atomic_fetch_add(&h->refs, 1, __ATOMIC_RELAXED);
+        return p;
+}
+
+/**
+ * @brief Initializes a pool for the nodes of btrees with the given key and
+ * value sizes.
+ *
+ * Trees created on the pool with @ref btree_create_pooled take their nodes
+ * from it and give them back when they merge, so splits and merges recycle
+ * nodes instead of calling `malloc` and `free`. Every call to
+ * btree_pool_create **must** have a matching call to
+ * @ref btree_pool_destroy to release the managed memory.
+ *
+ * @param key_size Size of each key.
+ * @param val_size Size of each value.
+ * @return Handle to the pool.
+ */
+struct btree_pool*
+btree_pool_create(size_t key_size, size_t val_size)
+{
+        struct btree_pool* pool = malloc(sizeof(struct btree_pool));
+
+        pool->_key_size = key_size;
+        pool->_val_size = val_size;
+        pool->_t = block_degree(key_size, val_size, _btree_block_size);
+        pool->_node_size = node_size(key_size, val_size, pool->_t);
+        pool->_chunks = slice_make(sizeof(byte*), 1);
+        pool->_chunk = 0;
+        pool->_used = _btree_pool_nodes;
+        pool->_free = NULL;
+
+        return pool;
+}
+
+/**
+ * @brief Initializes a btree whose nodes come from a pool.
+ *
+ * Like @ref btree_create, with the key and value sizes of the pool. The tree
+ * **may** be released with @ref btree_destroy, which gives its nodes back to
+ * the pool, or all at once with the rest of the pool by
+ * @ref btree_pool_reset or @ref btree_pool_destroy.
+ *
+ * @param pool Handle to the pool.
+ * @return Handle to the btree.
+ */
+struct btree*
+btree_create_pooled(struct btree_pool* pool)
+{
+        return node_make(pool->_key_size, pool->_val_size, pool->_t, pool);
+}
+
+/**
+ * @brief Releases every node on a pool at once.
+ *
+ * Every tree created on the pool is gone afterwards and **must not** be used
+ * or destroyed. Runs in constant time: the chunks are kept and handed out
+ * again, from the first one.
+ *
+ * @param pool Handle to the pool.
+ */
+void
+btree_pool_reset(struct btree_pool* pool)
+{
+        pool->_chunk = 0;
+        pool->_used = pool->_chunks->len > 0 ? 0 : _btree_pool_nodes;
+        pool->_free = NULL;
+}
+
+/**
+ * @brief Deallocates the memory managed by a pool created with
+ * @ref btree_pool_create.
+ *
+ * Releases every node on the pool, along with every tree created on it.
+ *
+ * @param pool Handle to the pool.
+ */
+void
+btree_pool_destroy(struct btree_pool* pool)
+{
+        for (size_t i = 0; i < pool->_chunks->len; ++i)
+        {
+                free(*(byte**)slice_at(pool->_chunks, i));
+        }
+        slice_del(pool->_chunks);
+        free(pool);
+}
+
+static void*
+pool_alloc(struct btree_pool* pool)
+{
+        if (pool->_free != NULL)
+        {
+                void* p = pool->_free;
+                pool->_free = *(void**)p;
+                return p;
+        }
+
+        if (pool->_used == _btree_pool_nodes)
+        {
+                // Move on to the next chunk, reusing the ones kept by a reset
+                // before allocating new ones.
+                if (pool->_chunks->len > 0)
+                {
+                        ++pool->_chunk;
+                }
+                if (pool->_chunk == pool->_chunks->len)
+                {
+                        byte* chunk
+                            = malloc(_btree_pool_nodes * pool->_node_size);
+                        slice_sappend(pool->_chunks, &chunk);
+                }
+                pool->_used = 0;
+        }
+
+        byte* chunk = *(byte**)slice_at(pool->_chunks, pool->_chunk);
+        return chunk + pool->_used++ * pool->_node_size;
+}
+
+static inline size_t
+word_align(size_t size)
+{
+        // Rounds up to the alignment of size_t, so whatever follows can be
+        // read in place.
+        return (size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+}
+
+static size_t
+node_size(size_t key_size, size_t val_size, size_t t)
+{
+        // The header and the three slice handles, followed by their arrays.
+        // Children come first, and every array is padded, so they all stay
+        // aligned.
+        return sizeof(struct _btree) + 3 * sizeof(struct _slice)
+               + 2 * t * sizeof(struct btree*)
+               + word_align((2 * t - 1) * key_size)
+               + word_align((2 * t - 1) * val_size);
+}
+
+static struct slice*
+node_slice(struct _slice* s, byte** data, size_t el_size, size_t el_no)
+{
+        s->data = *data;
+        s->len = 0;
+        s->capacity = el_no * el_size;
+        s->el_size = el_size;
+        s->align = 0;
+        s->growth = SLICE_GROW_SCALE;
+        s->owned = false;
+        s->mapped = false;
+        *data += word_align(s->capacity);
+
+        return (struct slice*)s;
+}
+
+static struct btree*
+node_make(size_t key_size, size_t val_size, size_t t, struct btree_pool* pool)
+{
+        // A node is a single block. Its slices are never grown (a node never
+        // holds more than 2t - 1 keys), so they can point into it.
+        struct _btree* h = pool != NULL
+                               ? pool_alloc(pool)
+                               : malloc(node_size(key_size, val_size, t));
+        struct _slice* slices = (struct _slice*)(h + 1);
+        byte* data = (byte*)(slices + 3);
+
+        h->t = t;
+        h->pool = pool;
+        h->refs = 1;
+        h->splits = 0;
+        h->merges = 0;
+        h->children
+            = node_slice(slices, &data, sizeof(struct btree*), 2 * t);
+        h->keys = node_slice(slices + 1, &data, key_size, 2 * t - 1);
+        h->values = node_slice(slices + 2, &data, val_size, 2 * t - 1);
+
+        return (struct btree*)h;
+}
+
+static void
+node_del(struct btree* p)
+{
+        struct btree_pool* pool = ((struct _btree*)p)->pool;
+        if (pool != NULL)
+        {
+                *(void**)p = pool->_free;
+                pool->_free = p;
+        }
+        else
+        {
+                free(p);
+        }
+}
+
+static struct btree*
+node_own(struct btree** p)
+{
+        // Nodes shared with a snapshot are never changed in place. The first
+        // change copies the node, and the copy takes its place on the tree.
+        struct _btree* h = (struct _btree*)*p;
+        if (__atomic_load_n(&h->refs, __ATOMIC_ACQUIRE) == 1)
+        {
+                return *p;
+        }
+
+        struct _slice* keys = (struct _slice*)(*p)->keys;
+        struct _slice* values = (struct _slice*)(*p)->values;
+        struct btree* copy
+            = node_make(keys->el_size, values->el_size, h->t, h->pool);
+        ((struct _btree*)copy)->splits = h->splits;
+        ((struct _btree*)copy)->merges = h->merges;
+
+        memcpy(copy->keys->data, keys->data, keys->len * keys->el_size);
+        memcpy(copy->values->data, values->data,
+               values->len * values->el_size);
+        memcpy(copy->children->data, (*p)->children->data,
+               childno(*p) * sizeof(struct btree*));
+        copy->keys->len = keys->len;
+        copy->values->len = values->len;
+        copy->children->len = childno(*p);
+
+        // The children are now shared between the node and its copy.
+        for (size_t i = 0; i < childno(copy); ++i)
+        {
+                struct _btree* child = *(struct _btree**)child_at(copy, i);
+                __atomic_fetch_add(&child->refs, 1, __ATOMIC_RELAXED);
+        }
+
+        btree_destroy(*p);
+        *p = copy;
+        return copy;
 }
 
 /**
@@ -121,7 +640,7 @@ void
 btree_insert(struct btree** p, void* key, void* value,
              int (*cmp)(void*, void*))
 {
-        struct _btree* h = (struct _btree*)*p;
+        struct _btree* h = (struct _btree*)node_own(p);
 
         if (keyno(*p) == 2 * h->t - 1)
         {
@@ -188,30 +707,605 @@ btree_search(struct btree* p, data* key, int (*cmp)(data*, data*))
 bool
 btree_remove(struct btree** p, void* key, int (*cmp)(void*, void*))
 {
+        // Single pass from the root down. Every node on the way is refilled
+        // to at least t keys before descending into it, so the leaf the key
+        // is removed from never underflows.
+        enum
+        {
+                REMOVE_KEY,  // Searching for the key.
+                REMOVE_PRED, // Removing the last key of a subtree.
+                REMOVE_SUCC, // Removing the first key of a subtree.
+        } target
+            = REMOVE_KEY;
+        size_t key_size = ((struct _slice*)(*p)->keys)->el_size;
+        size_t val_size = ((struct _slice*)(*p)->values)->el_size;
+        // Where the predecessor or successor goes, on the internal node the
+        // key was found on.
+        byte* hole_key = NULL;
+        byte* hole_val = NULL;
+        // Position of the key on the next node, when a merge already knows.
+        size_t known = SIZE_MAX;
+
+        while (true)
+        {
+                struct btree* x = node_own(p);
+                struct _btree* h = (struct _btree*)x;
+                size_t i;
+                bool found;
+
+                if (target == REMOVE_KEY && known != SIZE_MAX)
+                {
+                        i = known;
+                        found = true;
+                        known = SIZE_MAX;
+                }
+                else if (target == REMOVE_KEY)
+                {
+                        i = find_match(x, key, cmp, &found);
+                }
+                // The predecessor and successor are found without comparing
+                // keys: they are the last and first keys of their subtrees.
+                else if (target == REMOVE_PRED)
+                {
+                        i = leaf(x) ? keyno(x) - 1 : keyno(x);
+                        found = leaf(x);
+                }
+                else
+                {
+                        i = 0;
+                        found = leaf(x);
+                }
+
+                if (leaf(x))
+                {
+                        if (!found)
+                        {
+                                return false;
+                        }
+                        if (hole_key != NULL)
+                        {
+                                memcpy(hole_key, key_at(x, i), key_size);
+                                memcpy(hole_val, val_at(x, i), val_size);
+                        }
+                        slice_delete_at(x->keys, i);
+                        slice_delete_at(x->values, i);
+                        return true;
+                }
+
+                if (!found)
+                {
+                        // The key could only be in the subtree rooted at the
+                        // ith child.
+                        p = refill_child(p, i);
+                        continue;
+                }
+
+                // The key is on this internal node. Replace it with its
+                // predecessor or successor, from whichever child can spare a
+                // key, and remove that one instead. This node is not changed
+                // again on the way down, so the key can be overwritten once
+                // the leaf is reached.
+                if (keyno(*child_at(x, i)) >= h->t
+                    || keyno(*child_at(x, i + 1)) >= h->t)
+                {
+                        target = keyno(*child_at(x, i)) >= h->t ? REMOVE_PRED
+                                                                : REMOVE_SUCC;
+                        hole_key = (byte*)key_at(x, i);
+                        hole_val = (byte*)val_at(x, i);
+                        p = child_at(x, target == REMOVE_PRED ? i : i + 1);
+                        continue;
+                }
+
+                // Both children have t - 1 keys. Merge them around the key,
+                // which ends up in the middle of the merged node. The merge
+                // may free this node, if it was the root.
+                known = h->t - 1;
+                p = merge(p, i);
+        }
+}
+
+/**
+ * @brief Moves a cursor to the first entry whose key is not smaller than the
+ * given key.
+ *
+ * Positions the cursor on the given key if it is on the tree, or on the entry
+ * that would come right after it otherwise. A null key positions the cursor
+ * on the first entry of the tree. The comparator receives a pointer to the
+ * given key, and a pointer to the key being compared, respectively.
+ *
+ * @param c Cursor to position.
+ * @param p Handle to the tree.
+ * @param key Handle to the key to seek, **may** be null.
+ * @param cmp Search comparator.
+ * @return Whether or not the cursor is on an entry.
+ */
+bool
+btree_seek(struct btree_cursor* c, struct btree* p, data* key,
+           int (*cmp)(data*, data*))
+{
+        c->_depth = 0;
+        if (key == NULL)
+        {
+                return cursor_down(c, p, false);
+        }
+
+        while (true)
+        {
+                size_t i = find_key(p, key, cmp);
+                c->_nodes[c->_depth] = p;
+                c->_idx[c->_depth] = i;
+                ++c->_depth;
+
+                if (i < keyno(p) && cmp(key, slice_at(p->keys, i)) == 0)
+                {
+                        return true;
+                }
+                if (leaf(p))
+                {
+                        // Every key on the leaf is smaller, the next entry
+                        // is the first ancestor with a key after this path.
+                        return i < keyno(p) || cursor_up(c, false);
+                }
+                p = *child_at(p, i);
+        }
+}
+
+/**
+ * @brief Moves a cursor to the next entry, in key order.
+ *
+ * @param c Cursor on an entry.
+ * @return Whether or not the cursor is on an entry. False if it moved past
+ * the last entry.
+ */
+bool
+btree_next(struct btree_cursor* c)
+{
+        struct btree* p = c->_nodes[c->_depth - 1];
+        size_t i = c->_idx[c->_depth - 1];
+
+        if (!leaf(p))
+        {
+                // The next entry is the smallest on the right subtree.
+                c->_idx[c->_depth - 1] = i + 1;
+                return cursor_down(c, *child_at(p, i + 1), false);
+        }
+        if (i + 1 < keyno(p))
+        {
+                c->_idx[c->_depth - 1] = i + 1;
+                return true;
+        }
+        return cursor_up(c, false);
+}
+
+/**
+ * @brief Moves a cursor to the previous entry, in key order.
+ *
+ * @param c Cursor on an entry.
+ * @return Whether or not the cursor is on an entry. False if it moved past
+ * the first entry.
+ */
+bool
+btree_prev(struct btree_cursor* c)
+{
+        struct btree* p = c->_nodes[c->_depth - 1];
+        size_t i = c->_idx[c->_depth - 1];
+
+        if (!leaf(p))
+        {
+                // The previous entry is the largest on the left subtree.
+                return cursor_down(c, *child_at(p, i), true);
+        }
+        if (i > 0)
+        {
+                c->_idx[c->_depth - 1] = i - 1;
+                return true;
+        }
+        return cursor_up(c, true);
+}
+
+/**
+ * @brief Returns a handle to the key under a cursor.
+ *
+ * @param c Cursor on an entry.
+ */
+data*
+btree_cursor_key(struct btree_cursor* c)
+{
+        return slice_at(c->_nodes[c->_depth - 1]->keys,
+                        c->_idx[c->_depth - 1]);
+}
+
+/**
+ * @brief Returns a handle to the value under a cursor.
+ *
+ * @param c Cursor on an entry.
+ */
+data*
+btree_cursor_value(struct btree_cursor* c)
+{
+        return slice_at(c->_nodes[c->_depth - 1]->values,
+                        c->_idx[c->_depth - 1]);
+}
+
+/**
+ * @brief Calls a function on every entry with a key between two bounds, in
+ * key order.
+ *
+ * Visits the entries whose keys are in `[lo, hi]`. A null bound leaves that
+ * side of the range open. The callback receives a pointer to the key, a
+ * pointer to the value and the given context, respectively, and **must not**
+ * change the tree.
+ *
+ * @param p Handle to the tree.
+ * @param lo Handle to the smallest key to visit, **may** be null.
+ * @param hi Handle to the largest key to visit, **may** be null.
+ * @param cmp Search comparator.
+ * @param callback Function to call on each entry.
+ * @param ctx Passed to the callback as is.
+ * @return Number of entries visited.
+ */
+size_t
+btree_range(struct btree* p, data* lo, data* hi, int (*cmp)(data*, data*),
+            void (*callback)(data* key, data* value, data* ctx), data* ctx)
+{
+        struct btree_cursor c;
+        size_t n = 0;
+
+        for (bool ok = btree_seek(&c, p, lo, cmp); ok; ok = btree_next(&c))
+        {
+                data* key = btree_cursor_key(&c);
+                if (hi != NULL && cmp(key, hi) > 0)
+                {
+                        break;
+                }
+                callback(key, btree_cursor_value(&c), ctx);
+                ++n;
+        }
+
+        return n;
+}
+
+/**
+ * @brief Measures the shape and memory usage of a tree.
+ *
+ * Walks every node once. Shows how full nodes are, to tune the degree and
+ * spot trees left sparse by removals, and how many splits and merges it
+ * took to get there. The counters of a @ref btree_snapshot include those of
+ * the tree it was taken from.
+ *
+ * @param p Handle to the tree.
+ * @param stats Where to write the statistics.
+ */
+void
+btree_stats(struct btree* p, struct btree_stats* stats)
+{
+        memset(stats, 0, sizeof(struct btree_stats));
+        stats_walk(p, 0, stats);
+
+        size_t t = ((struct _btree*)p)->t;
+        stats->fill = (double)stats->entries / (stats->nodes * (2 * t - 1));
+}
+
+/**
+ * @brief Inserts many entries into the tree at once.
+ *
+ * Sorts the batch, then inserts it in key order. Consecutive keys usually
+ * land on the same leaf, so while the next key is within the bounds of the
+ * leaf the previous one went to and the leaf has room, it is inserted there
+ * without descending from the root again. The result is the same as calling
+ * @ref btree_insert on every entry. The comparator receives a pointer to the
+ * given key, and a pointer to the key being compared, respectively.
+ * **May** update the root pointer.
+ *
+ * @param p Handle to the root of the tree.
+ * @param keys Pointer to the first of `n` keys.
+ * @param values Pointer to the first of `n` values, in the order of the keys.
+ * @param n Number of entries.
+ * @param cmp Insertion comparator.
+ */
+void
+btree_insert_batch(struct btree** p, data* keys, data* values, size_t n,
+                   int (*cmp)(void*, void*))
+{
+        if (n == 0)
+        {
+                return;
+        }
+
+        size_t key_size = ((struct _slice*)(*p)->keys)->el_size;
+        size_t val_size = ((struct _slice*)(*p)->values)->el_size;
+        struct slice* batch = batch_sort(keys, values, n, key_size, key_size,
+                                         val_size, cmp);
+
+        // Bounds of the leaf the last key went to: keys strictly between the
+        // separators around it belong to the same leaf.
+        byte* lo = malloc(2 * key_size);
+        byte* hi = lo + key_size;
+        bool has_lo = false;
+        bool has_hi = false;
+        struct btree* finger = NULL;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+                byte* key = slice_at(batch, i);
+                byte* value = key + key_size;
+
+                if (finger != NULL
+                    && keyno(finger) < 2 * ((struct _btree*)finger)->t - 1
+                    && (!has_lo || cmp(key, lo) > 0)
+                    && (!has_hi || cmp(key, hi) < 0))
+                {
+                        size_t j = find_key(finger, key, cmp);
+                        slice_insert(finger->keys, key, j);
+                        slice_insert(finger->values, value, j);
+                }
+                else
+                {
+                        finger = insert_bounded(p, key, value, cmp, lo, hi,
+                                                &has_lo, &has_hi);
+                }
+        }
+
+        free(lo);
+        slice_del(batch);
+}
+
+/**
+ * @brief Finds many keys on the tree at once.
+ *
+ * Sorts the batch, then searches it in a single walk down the tree: each node
+ * is visited once for every key that goes through it, and keys bound to the
+ * same child descend together. The children a group is about to visit are
+ * prefetched while the rest of the node is compared. Writes the value of
+ * every key to `values`, in the order of the keys, or null for keys that are
+ * not on the tree. The comparator receives a pointer to the given key, and a
+ * pointer to the key being compared, respectively.
+ *
+ * @param p Handle to the tree.
+ * @param keys Pointer to the first of `n` keys.
+ * @param n Number of keys.
+ * @param values Array of `n` handles, one for the value of each key.
+ * @param cmp Search comparator.
+ */
+void
+btree_search_batch(struct btree* p, data* keys, size_t n, data** values,
+                   int (*cmp)(data*, data*))
+{
+        if (n == 0)
+        {
+                return;
+        }
+
+        // Each key is sorted along with its index on the batch.
+        size_t key_size = ((struct _slice*)p->keys)->el_size;
+        size_t* idx = malloc(n * sizeof(size_t));
+        for (size_t i = 0; i < n; ++i)
+        {
+                idx[i] = i;
+        }
+        struct slice* batch = batch_sort(keys, idx, n, key_size,
+                                         word_align(key_size),
+                                         sizeof(size_t), cmp);
+
+        search_group(p, batch, 0, n, idx, values, cmp);
+
+        free(idx);
+        slice_del(batch);
+}
+
+static struct slice*
+batch_sort(data* keys, data* values, size_t n, size_t key_size,
+           size_t val_offset, size_t val_size, int (*cmp)(void*, void*))
+{
+        // Entries are a key followed by its value. The comparator only reads
+        // the key, so it sorts the entries as they are. Entries are padded so
+        // every key stays aligned.
+        size_t el_size = word_align(val_offset + val_size);
+        struct slice* batch = slice_make(el_size, n);
+        struct slice* work = slice_make(el_size, n);
+        for (size_t i = 0; i < n; ++i)
+        {
+                byte* entry = slice_at(batch, i);
+                memcpy(entry, (byte*)keys + i * key_size, key_size);
+                memcpy(entry + val_offset, (byte*)values + i * val_size,
+                       val_size);
+        }
+        batch->len = n;
+
+        sort_merge(batch, work, cmp, 0, n - 1);
+
+        slice_del(work);
+        return batch;
+}
+
+static struct btree*
+insert_bounded(struct btree** p, void* key, void* value,
+               int (*cmp)(void*, void*), byte* lo, byte* hi, bool* has_lo,
+               bool* has_hi)
+{
+        // Same as btree_insert, iteratively, keeping track of the separators
+        // around the leaf the key goes to.
+        struct _btree* h = (struct _btree*)node_own(p);
+        if (keyno(*p) == 2 * h->t - 1)
+        {
+                split_root(p);
+        }
+
         struct btree* x = *p;
+        size_t key_size = ((struct _slice*)x->keys)->el_size;
+        *has_lo = false;
+        *has_hi = false;
+
+        while (!leaf(x))
+        {
+                size_t i = find_key(x, key, cmp);
+                if (keyno(*child_at(x, i)) == 2 * h->t - 1)
+                {
+                        split_child(x, i);
+                        if (cmp(key, key_at(x, i)) > 0)
+                        {
+                                ++i;
+                        }
+                }
+
+                if (i > 0)
+                {
+                        memcpy(lo, key_at(x, i - 1), key_size);
+                        *has_lo = true;
+                }
+                if (i < keyno(x))
+                {
+                        memcpy(hi, key_at(x, i), key_size);
+                        *has_hi = true;
+                }
+                x = node_own(child_at(x, i));
+        }
+
+        size_t i = find_key(x, key, cmp);
+        slice_insert(x->keys, key, i);
+        slice_insert(x->values, value, i);
 
-        size_t i = find_key(*p, key, cmp);
+        return x;
+}
+
+static void
+search_group(struct btree* p, struct slice* batch, size_t first, size_t n,
+             size_t* pos, data** values, int (*cmp)(data*, data*))
+{
+        // The keys in [first, first + n) are sorted and all go through p.
+        // pos is scratch space, each call only writes to its own range.
+        size_t offset = word_align(((struct _slice*)p->keys)->el_size);
+        size_t end = first + n;
 
-        // The key is on this node.
-        if (i < keyno(x) && cmp(key, slice_at(x->keys, i)) == 0)
+        for (size_t j = first; j < end; ++j)
         {
-                if (leaf(x))
+                pos[j] = find_key(p, slice_at(batch, j), cmp);
+                if (!leaf(p) && (j == first || pos[j] != pos[j - 1]))
+                {
+                        __builtin_prefetch(*child_at(p, pos[j]));
+                }
+        }
+
+        // Sorted keys bound to the same position are contiguous, the ones
+        // equal to the key at that position come last.
+        size_t j = first;
+        while (j < end)
+        {
+                size_t i = pos[j];
+                size_t run = j;
+                while (run < end && pos[run] == i)
+                {
+                        ++run;
+                }
+                size_t found = run;
+                while (found > j && i < keyno(p)
+                       && cmp(slice_at(batch, found - 1), key_at(p, i)) == 0)
+                {
+                        --found;
+                }
+
+                for (size_t k = found; k < run; ++k)
                 {
-                        return delete_from_leaf(x, i);
+                        byte* entry = slice_at(batch, k);
+                        values[*(size_t*)(entry + offset)] = val_at(p, i);
                 }
-                return delete_from_internal(p, key, i, cmp);
+
+                if (leaf(p))
+                {
+                        for (size_t k = j; k < found; ++k)
+                        {
+                                byte* entry = slice_at(batch, k);
+                                values[*(size_t*)(entry + offset)] = NULL;
+                        }
+                }
+                else if (found > j)
+                {
+                        if (run < end)
+                        {
+                                // Get the next group's keys on the way while
+                                // this one descends.
+                                __builtin_prefetch(
+                                    (*child_at(p, pos[run]))->keys);
+                        }
+                        search_group(*child_at(p, i), batch, j, found - j, pos,
+                                     values, cmp);
+                }
+                j = run;
+        }
+}
+
+static bool
+cursor_down(struct btree_cursor* c, struct btree* p, bool rightmost)
+{
+        // Pushes the path to the first (or last) entry under p.
+        while (!leaf(p))
+        {
+                size_t i = rightmost ? keyno(p) : 0;
+                c->_nodes[c->_depth] = p;
+                c->_idx[c->_depth] = i;
+                ++c->_depth;
+                p = *child_at(p, i);
         }
 
-        // The key is not on this node ...
-        // ... but it could be in the subtree rooted at the ith child.
-        if (!leaf(x))
+        if (keyno(p) == 0)
         {
-                return delete_from_subtree(p, key, i, cmp);
+                // Only the root of an empty tree has no keys.
+                c->_depth = 0;
+                return false;
+        }
+        c->_nodes[c->_depth] = p;
+        c->_idx[c->_depth] = rightmost ? keyno(p) - 1 : 0;
+        ++c->_depth;
+        return true;
+}
+
+static bool
+cursor_up(struct btree_cursor* c, bool backwards)
+{
+        // Pops the path until an ancestor has a key after (or before) the
+        // subtree the cursor came from. The key after child i is key i, the
+        // one before it is key i - 1.
+        while (--c->_depth > 0)
+        {
+                size_t* i = c->_idx + c->_depth - 1;
+                if (!backwards && *i < keyno(c->_nodes[c->_depth - 1]))
+                {
+                        return true;
+                }
+                if (backwards && *i > 0)
+                {
+                        --*i;
+                        return true;
+                }
         }
-        // ... and this is a leaf. The key is not on the tree.
         return false;
 }
 
+static void
+stats_walk(struct btree* p, size_t depth, struct btree_stats* s)
+{
+        struct _btree* h = (struct _btree*)p;
+        struct _slice* keys = (struct _slice*)p->keys;
+        struct _slice* values = (struct _slice*)p->values;
+        struct _slice* children = (struct _slice*)p->children;
+
+        s->height = max(s->height, depth + 1);
+        ++s->nodes;
+        ++s->level_nodes[depth];
+        s->entries += keyno(p);
+        s->bytes += node_size(keys->el_size, values->el_size, h->t);
+        s->capacity += keys->capacity + values->capacity + children->capacity;
+        s->used += keys->len * keys->el_size + values->len * values->el_size
+                   + children->len * children->el_size;
+        s->splits += h->splits;
+        s->merges += h->merges;
+
+        for (size_t i = 0; i < childno(p); ++i)
+        {
+                stats_walk(*child_at(p, i), depth + 1, s);
+        }
+}
+
 static inline bool
 leaf(struct btree* p)
 {
@@ -268,12 +1362,51 @@ child_at(struct btree* p, size_t idx)
 static size_t
 find_key(struct btree* p, data* key, int (*cmp)(data*, data*))
 {
-        size_t i = 0;
-        while (i < keyno(p) && cmp(key, key_at(p, i)) > 0)
+        // Binary search, or SIMD for integer keys compared with
+        // search_cmp_i32/search_cmp_i64.
+        size_t key_size = ((struct _slice*)p->keys)->el_size;
+        return search_lower_bound(p->keys->data, keyno(p), key_size, key, cmp);
+}
+
+static size_t
+find_match(struct btree* p, data* key, int (*cmp)(data*, data*), bool* found)
+{
+        // Like find_key, but also tells whether the key is on the node. The
+        // vectorized searches make no comparator calls, so they only need one
+        // more to check the key they stopped at. Otherwise a three-way binary
+        // search stops as soon as it hits the key, instead of comparing it
+        // again after finding its lower bound.
+        if (cmp == search_cmp_i32 || cmp == search_cmp_i64)
+        {
+                size_t i = find_key(p, key, cmp);
+                *found = i < keyno(p) && cmp(key, key_at(p, i)) == 0;
+                return i;
+        }
+
+        size_t key_size = ((struct _slice*)p->keys)->el_size;
+        size_t lo = 0;
+        size_t hi = keyno(p);
+        while (lo < hi)
         {
-                ++i;
+                size_t mid = lo + (hi - lo) / 2;
+                int c = cmp(key, (byte*)p->keys->data + mid * key_size);
+                if (c == 0)
+                {
+                        *found = true;
+                        return mid;
+                }
+                if (c > 0)
+                {
+                        lo = mid + 1;
+                }
+                else
+                {
+                        hi = mid;
+                }
         }
-        return i;
+
+        *found = false;
+        return lo;
 }
 
 static void
@@ -281,22 +1414,27 @@ split_child(struct btree* p, size_t i)
 {
         // Invariant: the i-th child is full.
         struct _btree* h = (struct _btree*)p;
-        struct btree* child = *(struct btree**)slice_at(p->children, i);
+        struct btree* child = node_own(child_at(p, i));
 
         size_t key_size = ((struct _slice*)p->keys)->el_size;
         size_t val_size = ((struct _slice*)p->values)->el_size;
-        struct btree* new_child = btree_create_t(key_size, val_size, h->t);
+        struct btree* new_child
+            = node_make(key_size, val_size, h->t, h->pool);
 
         // Copy the second half of the child to the new node (break the child
-        // in half).
+        // in half). The t - 1 keys after the median and their t children.
         memcpy(new_child->keys->data, slice_at(child->keys, h->t),
-               h->t * key_size);
+               (h->t - 1) * key_size);
         memcpy(new_child->values->data, slice_at(child->values, h->t),
-               h->t * val_size);
+               (h->t - 1) * val_size);
+        new_child->keys->len = h->t - 1;
+        new_child->values->len = h->t - 1;
         if (!leaf(child))
         {
                 memcpy(new_child->children->data,
-                       slice_at(child->children, h->t), (h->t + 1) * val_size);
+                       slice_at(child->children, h->t),
+                       h->t * sizeof(struct btree*));
+                new_child->children->len = h->t;
         }
 
         // Pull the median key/value from the child up to the parent.
@@ -318,6 +1456,7 @@ split_child(struct btree* p, size_t i)
         // Insert the new child right after the median element we
         // pulled up.
         slice_insert(p->children, &new_child, i + 1);
+        ++h->splits;
 }
 
 static void
@@ -330,7 +1469,7 @@ split_root(struct btree** p)
 
         // Parent the root to an empty note.
         struct btree* new_root
-            = btree_create_t(keys->el_size, values->el_size, h->t);
+            = node_make(keys->el_size, values->el_size, h->t, h->pool);
         slice_append(new_root->children, &root);
         *p = new_root;
 
@@ -362,10 +1501,10 @@ insert_non_full(struct btree* p, void* key, void* value,
                         // to insert after the new key.
                         if (cmp(key, key_at(p, i)) > 0)
                         {
-                                child = *child_at(p, i + 1);
+                                ++i;
                         }
                 }
-                insert_non_full(child, key, value, cmp);
+                insert_non_full(node_own(child_at(p, i)), key, value, cmp);
         }
 }
 
@@ -373,61 +1512,65 @@ static struct btree**
 merge(struct btree** root, size_t idx)
 {
         struct btree* parent = *root;
-        struct btree* target = *child_at(parent, idx);
-        struct btree* victim = *child_at(parent, idx + 1);
+        struct btree* target = node_own(child_at(parent, idx));
+        struct btree* victim = node_own(child_at(parent, idx + 1));
 
         // Merge the key ...
         slice_append(target->keys, key_at(parent, idx));
         slice_append(target->values, val_at(parent, idx));
 
-        // ... and the child into the previous child.
-        for (int i = 0; i < keyno(victim); ++i)
-        {
-                data* key = key_at(victim, i);
-                slice_append(target->keys, key);
-
-                data* val = val_at(victim, i);
-                slice_append(target->values, val);
-        }
+        // ... and the child into the previous child. The target has room for
+        // all of them, so these never grow it.
+        slice_extend(target->keys, victim->keys);
+        slice_extend(target->values, victim->values);
         if (!leaf(victim))
         {
-                for (int i = 0; i < childno(victim); ++i)
-                {
-                        struct btree** child = child_at(victim, i);
-                        slice_append(target->children, child);
-                }
+                slice_extend(target->children, victim->children);
         }
 
         // Delete the key we merged.
         slice_delete_at(parent->keys, idx);
         slice_delete_at(parent->values, idx);
 
-        // Delete the child we merged.
-        btree_destroy(victim);
+        // Delete the child we merged, keeping its counters on the tree.
+        struct _btree* ht = (struct _btree*)target;
+        struct _btree* hp = (struct _btree*)parent;
+        ht->splits += ((struct _btree*)victim)->splits;
+        ht->merges += ((struct _btree*)victim)->merges;
+        ++hp->merges;
+        node_del(victim);
         slice_delete_at(parent->children, idx + 1);
 
         if (keyno(parent) == 0)
         {
                 // The previous root is now empty, promote the child.
+                ht->splits += hp->splits;
+                ht->merges += hp->merges;
                 *root = target;
-                btree_destroy(parent);
+                node_del(parent);
                 return root;
         }
         return child_at(parent, idx);
 }
 
-// TODO Linux rebalances in a way that doesn't need to steal nodes.
+// Linux rebalances in a way that doesn't need to steal nodes: it removes the
+// key first and then walks back up, merging siblings that fit in one node and
+// leaving the others underfull.
 // https://github.com/torvalds/linux/blob/8bb886cb8f3a2811430ddb7d9838e245c57e7f7c/lib/btree.c#L535
+// That takes a second pass, up the tree. Refilling nodes on the way down
+// keeps removal to a single pass, at the cost of stealing a key when a
+// sibling can spare one.
 
 static void
 steal_prev(struct btree* parent, size_t idx)
 {
         size_t prev_idx = idx - 1;
-        struct btree* curr = *child_at(parent, idx);
-        struct btree* prev = *child_at(parent, prev_idx);
+        struct btree* curr = node_own(child_at(parent, idx));
+        struct btree* prev = node_own(child_at(parent, prev_idx));
 
-        // Copy the key from x down into the child.
-        // TODO slice_prepend
+        // Copy the key from x down into the child. Node arrays stay
+        // contiguous for binary search, so this shifts the child instead of
+        // using a deque, which costs at most 2t - 1 elements.
         slice_insert(curr->keys, key_at(parent, prev_idx), 0);
         slice_insert(curr->values, val_at(parent, prev_idx), 0);
 
@@ -451,11 +1594,10 @@ steal_prev(struct btree* parent, size_t idx)
 static void
 steal_next(struct btree* parent, size_t idx)
 {
-        struct btree* curr = *child_at(parent, idx);
-        struct btree* next = *child_at(parent, idx + 1);
+        struct btree* curr = node_own(child_at(parent, idx));
+        struct btree* next = node_own(child_at(parent, idx + 1));
 
         // Copy the key from x down into the child.
-        // TODO push_front
         slice_append(curr->keys, key_at(parent, idx));
         slice_append(curr->values, val_at(parent, idx));
 
@@ -463,6 +1605,7 @@ steal_next(struct btree* parent, size_t idx)
         // one we just moved down.
         slice_replace(parent->keys, slice_first(next->keys), idx);
         slice_replace(parent->values, slice_first(next->values), idx);
+        // Shifts the sibling, see steal_prev.
         slice_delete_at(next->keys, 0);
         slice_delete_at(next->values, 0);
 
@@ -475,82 +1618,18 @@ steal_next(struct btree* parent, size_t idx)
         }
 }
 
-static bool
-delete_from_leaf(struct btree* x, size_t i)
-{
-        slice_delete_at(x->keys, i);
-        slice_delete_at(x->values, i);
-
-        return true;
-}
-
-static bool
-delete_from_internal(struct btree** x, data* key, size_t i,
-                     int (*cmp)(void*, void*))
-{
-        struct btree* p = *x;
-        struct _btree* h = (struct _btree*)p;
-
-        struct btree** prev_child = child_at(p, i);
-        struct btree** next_child = child_at(p, i + 1);
-
-        if (keyno(*prev_child) >= h->t)
-        {
-                // Case 2a
-                // Find the predecessor.
-                struct btree** pred = prev_child;
-                while (!leaf(*pred))
-                {
-                        pred = slice_last((*pred)->children);
-                }
-
-                data* pred_key = slice_last((*pred)->keys);
-                data* pred_value = slice_last((*pred)->values);
-
-                // Replace the node we want to remove with its predecessor.
-                slice_replace(p->keys, pred_key, i);
-                slice_replace(p->values, pred_key, i);
-
-                // Recurse to delete the predecessor.
-                return btree_remove(pred, pred_key, cmp);
-        }
-        if (keyno(*next_child) >= h->t)
-        {
-                // Case 2b
-                // Find the successor.
-                struct btree** succ = next_child;
-                while (!leaf(*succ))
-                {
-                        succ = slice_first((*succ)->children);
-                }
-
-                data* succ_key = slice_first((*succ)->keys);
-                data* succ_value = slice_first((*succ)->values);
-
-                // Replace the node we want to remove with its succecessor.
-                slice_replace(p->keys, succ_key, i);
-                slice_replace(p->values, succ_key, i);
-
-                // Recurse to delete the succecessor.
-                return btree_remove(succ, succ_key, cmp);
-        }
-
-        // We know the root won't update, so it's not a problem, but I don't
-        // like the & here.
-        return btree_remove(merge(x, i), key, cmp);
-}
-
-static bool
-delete_from_subtree(struct btree** parent, void* key, size_t i,
-                    int (*cmp)(void*, void*))
+static struct btree**
+refill_child(struct btree** parent, size_t i)
 {
+        // Makes sure the ith child has at least t keys before descending into
+        // it, and returns where it ended up.
         struct _btree* h = (struct _btree*)*parent;
         struct btree** subtree = child_at(*parent, i);
 
         // There are enough keys on the subtree.
         if (keyno(*subtree) >= h->t)
         {
-                return btree_remove(subtree, key, cmp);
+                return subtree;
         }
 
         struct btree** prev_child = child_at(*parent, i - 1);
@@ -576,7 +1655,7 @@ delete_from_subtree(struct btree** parent, void* key, size_t i,
         }
 
         // Now there are enough keys on the subtree.
-        return btree_remove(subtree, key, cmp);
+        return subtree;
 }
 
 void
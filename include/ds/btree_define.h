@@ -0,0 +1,400 @@
+#pragma once
+#pragma icanc include
+#include <leet.h>
+#include <ds/btree.h>
+#pragma icanc end
+
+/**
+ * @file btree_define.h
+ *
+ * `#include <ds/btree_define.h>`
+ *
+ * Typed B-trees. A @ref btree works with any key through `void*` keys, a
+ * size known at runtime and a comparator called through a function pointer,
+ * none of which the compiler can see through. @ref BTREE_DEFINE generates a
+ * B-tree for one key and value type instead: keys and values live on typed
+ * arrays inside the node, are copied by assignment, and the comparator is an
+ * expression the compiler inlines into the search loop.
+ *
+ * For a tree named `name`, the generated API is:
+ *
+ * - `struct name* name_create(void)`
+ * - `void name_destroy(struct name* p)`
+ * - `void name_insert(struct name** p, key_t key, val_t value)`
+ * - `val_t* name_search(struct name* p, key_t key)`
+ * - `bool name_remove(struct name** p, key_t key)`
+ *
+ * which behave like their @ref btree counterparts without the comparator
+ * argument. Every generated function is `static inline`, so a tree **may** be
+ * defined in as many translation units as needed.
+ *
+ * ```c
+ * BTREE_DEFINE(itree, int, int, (a > b) - (a < b))
+ *
+ * struct itree* tree = itree_create();
+ * itree_insert(&tree, 42, 1);
+ * int* value = itree_search(tree, 42);
+ * itree_destroy(tree);
+ * ```
+ */
+
+/**
+ * @brief Defines a typed B-tree with a node sized like the ones from
+ * @ref btree_create.
+ *
+ * The degree is picked so each array on the node takes about
+ * @ref _btree_block_size bytes.
+ *
+ * @param name Name of the node struct, also used as the prefix for every
+ * generated function.
+ * @param key_t Type of the keys.
+ * @param val_t Type of the values.
+ * @param cmp_expr Expression comparing two `key_t` named `a` and `b`, that
+ * **must** evaluate to a negative number if `a < b`, zero if `a == b` and a
+ * positive number if `a > b`.
+ * @see BTREE_DEFINE_T
+ */
+#define BTREE_DEFINE(name, key_t, val_t, cmp_expr)                            \
+        BTREE_DEFINE_T(name, key_t, val_t, cmp_expr,                          \
+                       max(_btree_block_size                                  \
+                               / (2                                           \
+                                  * max(sizeof(key_t),                        \
+                                        max(sizeof(val_t), sizeof(void*)))),  \
+                           2))
+
+/**
+ * @brief Defines a typed B-tree of the given degree.
+ *
+ * Nodes hold between `degree - 1` and `2 * degree - 1` keys, except for the
+ * root.
+ *
+ * @param name Name of the node struct, also used as the prefix for every
+ * generated function.
+ * @param key_t Type of the keys.
+ * @param val_t Type of the values.
+ * @param cmp_expr Expression comparing two `key_t` named `a` and `b`.
+ * @param degree Degree of the tree, a constant expression no smaller than 2.
+ * @see BTREE_DEFINE
+ */
+#define BTREE_DEFINE_T(name, key_t, val_t, cmp_expr, degree)                  \
+        enum                                                                  \
+        {                                                                     \
+                name##_degree = (degree),                                     \
+                name##_max_keys = 2 * (degree) - 1,                           \
+        };                                                                    \
+                                                                              \
+        struct name                                                           \
+        {                                                                     \
+                size_t n;                                                     \
+                bool leaf;                                                    \
+                key_t keys[name##_max_keys];                                  \
+                val_t values[name##_max_keys];                                \
+                struct name* children[name##_max_keys + 1];                   \
+        };                                                                    \
+                                                                              \
+        static inline bool name##_remove(struct name** p, key_t key);         \
+                                                                              \
+        static inline int                                                     \
+        name##_cmp(key_t a, key_t b)                                          \
+        {                                                                     \
+                return (cmp_expr);                                            \
+        }                                                                     \
+                                                                              \
+        static inline struct name*                                            \
+        name##_node(bool leaf)                                                \
+        {                                                                     \
+                struct name* p = malloc(sizeof(struct name));                 \
+                p->n = 0;                                                     \
+                p->leaf = leaf;                                               \
+                return p;                                                     \
+        }                                                                     \
+                                                                              \
+        static inline struct name*                                            \
+        name##_create(void)                                                   \
+        {                                                                     \
+                return name##_node(true);                                     \
+        }                                                                     \
+                                                                              \
+        static inline void                                                    \
+        name##_destroy(struct name* p)                                        \
+        {                                                                     \
+                if (!p->leaf)                                                 \
+                {                                                             \
+                        for (size_t i = 0; i <= p->n; ++i)                    \
+                        {                                                     \
+                                name##_destroy(p->children[i]);               \
+                        }                                                     \
+                }                                                             \
+                free(p);                                                      \
+        }                                                                     \
+                                                                              \
+        static inline size_t                                                  \
+        name##_find(struct name* p, key_t key)                                \
+        {                                                                     \
+                /* Branchless binary search for the lower bound. */           \
+                key_t* base = p->keys;                                        \
+                size_t n = p->n;                                              \
+                if (n == 0)                                                   \
+                {                                                             \
+                        return 0;                                             \
+                }                                                             \
+                while (n > 1)                                                 \
+                {                                                             \
+                        size_t half = n / 2;                                  \
+                        base += (name##_cmp(key, base[half - 1]) > 0) * half; \
+                        n -= half;                                            \
+                }                                                             \
+                return (base - p->keys) + (name##_cmp(key, *base) > 0);       \
+        }                                                                     \
+                                                                              \
+        static inline void                                                    \
+        name##_split_child(struct name* p, size_t i)                          \
+        {                                                                     \
+                struct name* child = p->children[i];                          \
+                struct name* sibling = name##_node(child->leaf);              \
+                size_t t = name##_degree;                                     \
+                                                                              \
+                memcpy(sibling->keys, child->keys + t,                        \
+                       (t - 1) * sizeof(key_t));                              \
+                memcpy(sibling->values, child->values + t,                    \
+                       (t - 1) * sizeof(val_t));                              \
+                if (!child->leaf)                                             \
+                {                                                             \
+                        memcpy(sibling->children, child->children + t,        \
+                               t * sizeof(struct name*));                     \
+                }                                                             \
+                sibling->n = t - 1;                                           \
+                                                                              \
+                memmove(p->keys + i + 1, p->keys + i,                         \
+                        (p->n - i) * sizeof(key_t));                          \
+                memmove(p->values + i + 1, p->values + i,                     \
+                        (p->n - i) * sizeof(val_t));                          \
+                memmove(p->children + i + 2, p->children + i + 1,             \
+                        (p->n - i) * sizeof(struct name*));                   \
+                                                                              \
+                p->keys[i] = child->keys[t - 1];                              \
+                p->values[i] = child->values[t - 1];                          \
+                p->children[i + 1] = sibling;                                 \
+                ++p->n;                                                       \
+                child->n = t - 1;                                             \
+        }                                                                     \
+                                                                              \
+        static inline void                                                    \
+        name##_insert(struct name** p, key_t key, val_t value)                \
+        {                                                                     \
+                struct name* x = *p;                                          \
+                                                                              \
+                if (x->n == name##_max_keys)                                  \
+                {                                                             \
+                        struct name* root = name##_node(false);               \
+                        root->children[0] = x;                                \
+                        name##_split_child(root, 0);                          \
+                        *p = x = root;                                        \
+                }                                                             \
+                                                                              \
+                while (!x->leaf)                                              \
+                {                                                             \
+                        size_t i = name##_find(x, key);                       \
+                        if (x->children[i]->n == name##_max_keys)             \
+                        {                                                     \
+                                name##_split_child(x, i);                     \
+                                if (name##_cmp(key, x->keys[i]) > 0)          \
+                                {                                             \
+                                        ++i;                                  \
+                                }                                             \
+                        }                                                     \
+                        x = x->children[i];                                   \
+                }                                                             \
+                                                                              \
+                size_t i = name##_find(x, key);                               \
+                memmove(x->keys + i + 1, x->keys + i,                         \
+                        (x->n - i) * sizeof(key_t));                          \
+                memmove(x->values + i + 1, x->values + i,                     \
+                        (x->n - i) * sizeof(val_t));                          \
+                x->keys[i] = key;                                             \
+                x->values[i] = value;                                         \
+                ++x->n;                                                       \
+        }                                                                     \
+                                                                              \
+        static inline val_t*                                                  \
+        name##_search(struct name* p, key_t key)                              \
+        {                                                                     \
+                while (true)                                                  \
+                {                                                             \
+                        size_t i = name##_find(p, key);                       \
+                        if (i < p->n && name##_cmp(key, p->keys[i]) == 0)     \
+                        {                                                     \
+                                return p->values + i;                         \
+                        }                                                     \
+                        if (p->leaf)                                          \
+                        {                                                     \
+                                return NULL;                                  \
+                        }                                                     \
+                        p = p->children[i];                                   \
+                }                                                             \
+        }                                                                     \
+                                                                              \
+        static inline struct name**                                           \
+        name##_merge(struct name** root, size_t idx)                          \
+        {                                                                     \
+                struct name* parent = *root;                                  \
+                struct name* target = parent->children[idx];                  \
+                struct name* victim = parent->children[idx + 1];              \
+                size_t n = target->n;                                         \
+                                                                              \
+                target->keys[n] = parent->keys[idx];                          \
+                target->values[n] = parent->values[idx];                      \
+                memcpy(target->keys + n + 1, victim->keys,                    \
+                       victim->n * sizeof(key_t));                            \
+                memcpy(target->values + n + 1, victim->values,                \
+                       victim->n * sizeof(val_t));                            \
+                if (!victim->leaf)                                            \
+                {                                                             \
+                        memcpy(target->children + n + 1, victim->children,    \
+                               (victim->n + 1) * sizeof(struct name*));       \
+                }                                                             \
+                target->n = n + 1 + victim->n;                                \
+                                                                              \
+                memmove(parent->keys + idx, parent->keys + idx + 1,           \
+                        (parent->n - idx - 1) * sizeof(key_t));               \
+                memmove(parent->values + idx, parent->values + idx + 1,       \
+                        (parent->n - idx - 1) * sizeof(val_t));               \
+                memmove(parent->children + idx + 1,                           \
+                        parent->children + idx + 2,                           \
+                        (parent->n - idx - 1) * sizeof(struct name*));        \
+                --parent->n;                                                  \
+                free(victim);                                                 \
+                                                                              \
+                if (parent->n == 0)                                           \
+                {                                                             \
+                        *root = target;                                       \
+                        free(parent);                                         \
+                        return root;                                          \
+                }                                                             \
+                return parent->children + idx;                                \
+        }                                                                     \
+                                                                              \
+        static inline void                                                    \
+        name##_steal_prev(struct name* parent, size_t idx)                    \
+        {                                                                     \
+                struct name* curr = parent->children[idx];                    \
+                struct name* prev = parent->children[idx - 1];                \
+                                                                              \
+                memmove(curr->keys + 1, curr->keys, curr->n * sizeof(key_t)); \
+                memmove(curr->values + 1, curr->values,                       \
+                        curr->n * sizeof(val_t));                             \
+                curr->keys[0] = parent->keys[idx - 1];                        \
+                curr->values[0] = parent->values[idx - 1];                    \
+                if (!curr->leaf)                                              \
+                {                                                             \
+                        memmove(curr->children + 1, curr->children,           \
+                                (curr->n + 1) * sizeof(struct name*));        \
+                        curr->children[0] = prev->children[prev->n];          \
+                }                                                             \
+                ++curr->n;                                                    \
+                                                                              \
+                parent->keys[idx - 1] = prev->keys[prev->n - 1];              \
+                parent->values[idx - 1] = prev->values[prev->n - 1];          \
+                --prev->n;                                                    \
+        }                                                                     \
+                                                                              \
+        static inline void                                                    \
+        name##_steal_next(struct name* parent, size_t idx)                    \
+        {                                                                     \
+                struct name* curr = parent->children[idx];                    \
+                struct name* next = parent->children[idx + 1];                \
+                                                                              \
+                curr->keys[curr->n] = parent->keys[idx];                      \
+                curr->values[curr->n] = parent->values[idx];                  \
+                if (!curr->leaf)                                              \
+                {                                                             \
+                        curr->children[curr->n + 1] = next->children[0];      \
+                        memmove(next->children, next->children + 1,           \
+                                next->n * sizeof(struct name*));              \
+                }                                                             \
+                ++curr->n;                                                    \
+                                                                              \
+                parent->keys[idx] = next->keys[0];                            \
+                parent->values[idx] = next->values[0];                        \
+                memmove(next->keys, next->keys + 1,                           \
+                        (next->n - 1) * sizeof(key_t));                       \
+                memmove(next->values, next->values + 1,                       \
+                        (next->n - 1) * sizeof(val_t));                       \
+                --next->n;                                                    \
+        }                                                                     \
+                                                                              \
+        static inline bool                                                    \
+        name##_remove(struct name** p, key_t key)                             \
+        {                                                                     \
+                struct name* x = *p;                                          \
+                size_t i = name##_find(x, key);                               \
+                                                                              \
+                if (i < x->n && name##_cmp(key, x->keys[i]) == 0)             \
+                {                                                             \
+                        if (x->leaf)                                          \
+                        {                                                     \
+                                memmove(x->keys + i, x->keys + i + 1,         \
+                                        (x->n - i - 1) * sizeof(key_t));      \
+                                memmove(x->values + i, x->values + i + 1,     \
+                                        (x->n - i - 1) * sizeof(val_t));      \
+                                --x->n;                                       \
+                                return true;                                  \
+                        }                                                     \
+                        if (x->children[i]->n >= name##_degree)               \
+                        {                                                     \
+                                /* Swap in the predecessor. */                \
+                                struct name* pred = x->children[i];           \
+                                while (!pred->leaf)                           \
+                                {                                             \
+                                        pred = pred->children[pred->n];       \
+                                }                                             \
+                                x->keys[i] = pred->keys[pred->n - 1];         \
+                                x->values[i] = pred->values[pred->n - 1];     \
+                                return name##_remove(x->children + i,         \
+                                                     x->keys[i]);             \
+                        }                                                     \
+                        if (x->children[i + 1]->n >= name##_degree)           \
+                        {                                                     \
+                                /* Swap in the successor. */                  \
+                                struct name* succ = x->children[i + 1];       \
+                                while (!succ->leaf)                           \
+                                {                                             \
+                                        succ = succ->children[0];             \
+                                }                                             \
+                                x->keys[i] = succ->keys[0];                   \
+                                x->values[i] = succ->values[0];               \
+                                return name##_remove(x->children + i + 1,     \
+                                                     x->keys[i]);             \
+                        }                                                     \
+                        return name##_remove(name##_merge(p, i), key);        \
+                }                                                             \
+                                                                              \
+                if (x->leaf)                                                  \
+                {                                                             \
+                        return false;                                         \
+                }                                                             \
+                                                                              \
+                /* Give the subtree a key to spare. */                        \
+                struct name** subtree = x->children + i;                      \
+                if ((*subtree)->n < name##_degree)                            \
+                {                                                             \
+                        if (i > 0 && x->children[i - 1]->n >= name##_degree)  \
+                        {                                                     \
+                                name##_steal_prev(x, i);                      \
+                        }                                                     \
+                        else if (i < x->n                                     \
+                                 && x->children[i + 1]->n >= name##_degree)   \
+                        {                                                     \
+                                name##_steal_next(x, i);                      \
+                        }                                                     \
+                        else if (i > 0)                                       \
+                        {                                                     \
+                                subtree = name##_merge(p, i - 1);             \
+                        }                                                     \
+                        else                                                  \
+                        {                                                     \
+                                subtree = name##_merge(p, i);                 \
+                        }                                                     \
+                }                                                             \
+                return name##_remove(subtree, key);                           \
+        }
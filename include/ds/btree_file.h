@@ -0,0 +1,298 @@
+#pragma once
+#pragma icanc include
+#include <leet.h>
+#include <alg/search.h>
+#include <ds/btree.h>
+#pragma icanc end
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @file btree_file.h
+ *
+ * `#include <ds/btree_file.h>`
+ *
+ * An on-disk format for a @ref btree, read in place through `mmap`.
+ *
+ * The file starts with a header, followed by one fixed-size page per node.
+ * A page holds its key count, the offsets of its children from the start of
+ * the file, and its keys and values inline, laid out like a node of the tree
+ * it was written from. Offsets are relative, so the file **may** be mapped
+ * anywhere and needs no deserialization: opening it costs a single `mmap`
+ * call, and searches walk the mapped pages directly, loading them from disk
+ * as they are touched.
+ *
+ * Values are stored as raw bytes, so they **must not** hold pointers, and
+ * files are only readable on machines with the byte order and word size of
+ * the one that wrote them.
+ */
+
+/**
+ * @brief Identifies a btree file, along with the byte order it was written
+ * in.
+ */
+#define _btree_file_magic 0x6c65657462747231
+
+/**
+ * @brief Header of a btree file.
+ */
+struct _btree_file_header
+{
+        uint64_t magic;     ///< Always @ref _btree_file_magic.
+        uint64_t key_size;  ///< Size of each key.
+        uint64_t val_size;  ///< Size of each value.
+        uint64_t t;         ///< Degree of the tree.
+        uint64_t page_size; ///< Size of each page in bytes.
+        uint64_t pages;     ///< Number of pages after the header.
+        uint64_t root;      ///< Offset of the root page.
+};
+
+/**
+ * @brief Header of a page in a btree file.
+ *
+ * The offsets of the children are stored right after it, followed by the
+ * keys and then the values.
+ */
+struct _btree_page
+{
+        uint32_t n;        ///< Number of keys on the page.
+        uint32_t children; ///< Number of children, 0 on leaves.
+};
+
+/**
+ * @brief Handle to a btree file mapped into memory.
+ * @see btree_file_open
+ */
+struct btree_file
+{
+        /// @privatesection
+        byte* _base;                        ///< Start of the mapping.
+        size_t _size;                       ///< Size of the mapping in bytes.
+        struct _btree_file_header* _header; ///< Header, at the start.
+};
+
+static size_t page_size(size_t key_size, size_t val_size, size_t t);
+static uint64_t page_write(FILE* out, struct btree* p, byte* page,
+                           struct _btree_file_header* header);
+static inline uint64_t* page_children(struct _btree_page* p);
+static inline byte* page_keys(struct _btree_file_header* h,
+                              struct _btree_page* p);
+static inline byte* page_values(struct _btree_file_header* h,
+                                struct _btree_page* p);
+
+/**
+ * @brief Writes a tree to a file that can be opened with
+ * @ref btree_file_open.
+ *
+ * Overwrites the file if it exists. Writing takes a single pass over the
+ * tree, so a @ref btree_snapshot **may** be written in the background while
+ * the original keeps changing.
+ *
+ * @param p Handle to the tree.
+ * @param path Path of the file to write.
+ * @return Whether or not the whole tree was written.
+ */
+bool
+btree_file_write(struct btree* p, const char* path)
+{
+        FILE* out = fopen(path, "wb");
+        if (out == NULL)
+        {
+                return false;
+        }
+
+        struct _btree* h = (struct _btree*)p;
+        struct _btree_file_header header = {
+                .magic = _btree_file_magic,
+                .key_size = ((struct _slice*)p->keys)->el_size,
+                .val_size = ((struct _slice*)p->values)->el_size,
+                .t = h->t,
+                .pages = 0,
+        };
+        header.page_size
+            = page_size(header.key_size, header.val_size, header.t);
+
+        // Pages are written children first, so every offset on a page is
+        // known by the time it is written. The root is the last page, and
+        // the header is rewritten once its offset is known.
+        byte* page = malloc(header.page_size);
+        fwrite(&header, sizeof(header), 1, out);
+        header.root = page_write(out, p, page, &header);
+        free(page);
+
+        fseek(out, 0, SEEK_SET);
+        fwrite(&header, sizeof(header), 1, out);
+
+        bool ok = !ferror(out);
+        return fclose(out) == 0 && ok;
+}
+
+/**
+ * @brief Maps a file written by @ref btree_file_write into memory.
+ *
+ * The file is mapped read-only and nothing is read up front, so opening it
+ * takes constant time regardless of the size of the tree. Every call to
+ * btree_file_open that does not return null **must** have a matching call to
+ * @ref btree_file_close to release the mapping.
+ *
+ * @param path Path of the file to open.
+ * @return Handle to the file, or null if it could not be mapped or was not
+ * written by @ref btree_file_write on a compatible machine.
+ */
+struct btree_file*
+btree_file_open(const char* path)
+{
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+        {
+                return NULL;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0
+            || (size_t)st.st_size < sizeof(struct _btree_file_header))
+        {
+                close(fd);
+                return NULL;
+        }
+
+        // The mapping outlives the descriptor.
+        byte* base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED)
+        {
+                return NULL;
+        }
+
+        // Only the header is checked, pages are trusted as they are.
+        struct _btree_file_header* h = (struct _btree_file_header*)base;
+        if (h->magic != _btree_file_magic
+            || h->page_size != page_size(h->key_size, h->val_size, h->t)
+            || (size_t)st.st_size != sizeof(*h) + h->pages * h->page_size
+            || h->root + h->page_size > (size_t)st.st_size)
+        {
+                munmap(base, st.st_size);
+                return NULL;
+        }
+
+        struct btree_file* f = malloc(sizeof(struct btree_file));
+        f->_base = base;
+        f->_size = st.st_size;
+        f->_header = h;
+
+        return f;
+}
+
+/**
+ * @brief Unmaps a file opened with @ref btree_file_open.
+ *
+ * Handles to values on the file **must not** be used afterwards.
+ *
+ * @param f Handle to the file.
+ */
+void
+btree_file_close(struct btree_file* f)
+{
+        munmap(f->_base, f->_size);
+        free(f);
+}
+
+/**
+ * @brief Finds a key on a btree file and returns a handle to its value, if it
+ * exists.
+ *
+ * Same as @ref btree_search, on the mapped pages. Returns null if the key is
+ * not on the tree. The handle points into the mapping and is read-only. The
+ * comparator receives a pointer to the given key, and a pointer to the key
+ * being compared, respectively.
+ *
+ * @param f Handle to the file.
+ * @param key Handle to the key to search for.
+ * @param cmp Search comparator.
+ */
+data*
+btree_file_search(struct btree_file* f, data* key, int (*cmp)(data*, data*))
+{
+        struct _btree_file_header* h = f->_header;
+        struct _btree_page* p = (struct _btree_page*)(f->_base + h->root);
+
+        while (true)
+        {
+                byte* keys = page_keys(h, p);
+                size_t i
+                    = search_lower_bound(keys, p->n, h->key_size, key, cmp);
+
+                if (i < p->n && cmp(key, keys + i * h->key_size) == 0)
+                {
+                        return page_values(h, p) + i * h->val_size;
+                }
+                if (p->children == 0)
+                {
+                        return NULL;
+                }
+                p = (struct _btree_page*)(f->_base + page_children(p)[i]);
+        }
+}
+
+static size_t
+page_size(size_t key_size, size_t val_size, size_t t)
+{
+        // Same layout as a node: children, then keys, then values, each
+        // padded so the next one stays aligned.
+        return sizeof(struct _btree_page) + 2 * t * sizeof(uint64_t)
+               + word_align((2 * t - 1) * key_size)
+               + word_align((2 * t - 1) * val_size);
+}
+
+static inline uint64_t*
+page_children(struct _btree_page* p)
+{
+        return (uint64_t*)(p + 1);
+}
+
+static inline byte*
+page_keys(struct _btree_file_header* h, struct _btree_page* p)
+{
+        return (byte*)(page_children(p) + 2 * h->t);
+}
+
+static inline byte*
+page_values(struct _btree_file_header* h, struct _btree_page* p)
+{
+        return page_keys(h, p) + word_align((2 * h->t - 1) * h->key_size);
+}
+
+static uint64_t
+page_write(FILE* out, struct btree* p, byte* page,
+           struct _btree_file_header* header)
+{
+        // Writes the subtree under p and returns the offset of its root. The
+        // page buffer is shared by every call, so children are written before
+        // it is filled.
+        uint64_t children[2 * header->t];
+        for (size_t i = 0; i < childno(p); ++i)
+        {
+                children[i] = page_write(out, *child_at(p, i), page, header);
+        }
+
+        // Unused slots are zeroed, so the same tree always makes the same
+        // file.
+        struct _btree_page* pg = (struct _btree_page*)page;
+        memset(page, 0, header->page_size);
+        pg->n = keyno(p);
+        pg->children = childno(p);
+        memcpy(page_children(pg), children, childno(p) * sizeof(uint64_t));
+        memcpy(page_keys(header, pg), p->keys->data,
+               keyno(p) * header->key_size);
+        memcpy(page_values(header, pg), p->values->data,
+               keyno(p) * header->val_size);
+
+        fwrite(page, header->page_size, 1, out);
+
+        return sizeof(*header) + header->pages++ * header->page_size;
+}
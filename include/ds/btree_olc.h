@@ -0,0 +1,548 @@
+#pragma once
+#pragma icanc include
+#include <leet.h>
+#include <alg/search.h>
+#pragma icanc end
+
+#include <stdint.h>
+
+/**
+ * @file btree_olc.h
+ *
+ * `#include <ds/btree_olc.h>`
+ *
+ * A B-tree that **may** be searched and modified from many threads at once,
+ * with [optimistic lock coupling](https://db.in.tum.de/~leis/papers/artsync.pdf).
+ *
+ * Every node has a version that writers bump when they unlock it. Readers
+ * take no locks: they note the version of a node, read it, and check that the
+ * version did not change before trusting what they read, restarting from the
+ * root if it did. Writers descend the same way and only lock the nodes they
+ * change: the leaf they insert into or remove from, or a full node and its
+ * parent while splitting it. Full nodes are split on the way down, so a split
+ * never has to go back up the tree.
+ *
+ * Like a @ref bptree, entries live on the leaves and internal nodes only hold
+ * keys. Removing keys does not merge nodes, so no node is freed while another
+ * thread might still be reading it: leaves **may** be left underfull or
+ * empty, and memory is only released by @ref btree_olc_destroy.
+ */
+
+/**
+ * @brief Size of a cache line in bytes. Nodes are aligned to and sized in
+ * multiples of this.
+ */
+#define _BTREE_OLC_CACHE_LINE 64
+
+/**
+ * @brief Number of cache lines per node.
+ */
+#define _BTREE_OLC_LINES 4
+
+/**
+ * @brief Header of a node in a concurrent B-tree.
+ *
+ * The keys are stored inline right after it, followed by the values on
+ * leaves or the children on internal nodes.
+ */
+struct _btree_olc_node
+{
+        uint64_t version; ///< Bit 1 is set while locked, unlocking adds 2.
+        uint32_t n;       ///< Number of keys on the node.
+        bool leaf;        ///< Whether the node has no children.
+};
+
+/**
+ * @brief Handle to a concurrent B-tree.
+ * @see btree_olc_create
+ */
+struct btree_olc
+{
+        /// @privatesection
+        struct _btree_olc_node* _root; ///< Root node, changes on root splits.
+        size_t _key_size;              ///< Size of each key in bytes.
+        size_t _val_size;              ///< Size of each value in bytes.
+        size_t _leaf_max;              ///< Maximum entries on a leaf.
+        size_t _inner_max;             ///< Maximum keys on an internal node.
+};
+
+static struct _btree_olc_node* _btree_olc_node(struct btree_olc* t,
+                                               bool leaf);
+static void _btree_olc_free(struct btree_olc* t, struct _btree_olc_node* p);
+static void _btree_olc_split(struct btree_olc* t,
+                             struct _btree_olc_node* parent, size_t i,
+                             struct _btree_olc_node* p);
+
+/**
+ * @brief Initializes a concurrent B-tree.
+ *
+ * Nodes are sized to fit as many entries as @ref _BTREE_OLC_LINES cache lines
+ * hold, but hold at least 3 keys, so nodes with large keys span more lines.
+ * Every call to btree_olc_create **must** have a matching call to
+ * @ref btree_olc_destroy to release the managed memory.
+ *
+ * @param key_size Size of each key.
+ * @param val_size Size of each value.
+ * @return Handle to the tree.
+ */
+struct btree_olc*
+btree_olc_create(size_t key_size, size_t val_size)
+{
+        struct btree_olc* t = malloc(sizeof(struct btree_olc));
+        size_t bytes = _BTREE_OLC_LINES * _BTREE_OLC_CACHE_LINE
+                       - sizeof(struct _btree_olc_node);
+
+        t->_key_size = key_size;
+        t->_val_size = val_size;
+        t->_leaf_max = max(bytes / (key_size + val_size), 3);
+        t->_inner_max = max((bytes - sizeof(struct _btree_olc_node*))
+                                / (key_size + sizeof(struct _btree_olc_node*)),
+                            3);
+        t->_root = _btree_olc_node(t, true);
+
+        return t;
+}
+
+/**
+ * @brief Deallocates the memory managed by a tree created with
+ * @ref btree_olc_create.
+ *
+ * Releases every node on the tree. **Must not** be called while other threads
+ * are still using the tree.
+ *
+ * @param t Handle to the tree.
+ */
+void
+btree_olc_destroy(struct btree_olc* t)
+{
+        _btree_olc_free(t, t->_root);
+        free(t);
+}
+
+static inline byte*
+_btree_olc_key(struct btree_olc* t, struct _btree_olc_node* p, size_t idx)
+{
+        return (byte*)p + sizeof(struct _btree_olc_node) + idx * t->_key_size;
+}
+
+static inline byte*
+_btree_olc_val(struct btree_olc* t, struct _btree_olc_node* p, size_t idx)
+{
+        return _btree_olc_key(t, p, t->_leaf_max) + idx * t->_val_size;
+}
+
+static inline size_t
+_btree_olc_children(struct btree_olc* t)
+{
+        // Offset of the children on an internal node, aligned for pointers.
+        size_t offset = sizeof(struct _btree_olc_node)
+                        + t->_inner_max * t->_key_size;
+        return (offset + sizeof(struct _btree_olc_node*) - 1)
+               & ~(sizeof(struct _btree_olc_node*) - 1);
+}
+
+static inline struct _btree_olc_node**
+_btree_olc_child(struct btree_olc* t, struct _btree_olc_node* p, size_t idx)
+{
+        return (struct _btree_olc_node**)((byte*)p + _btree_olc_children(t))
+               + idx;
+}
+
+static inline size_t
+_btree_olc_keyno(struct btree_olc* t, struct _btree_olc_node* p)
+{
+        // Optimistic readers may see a count that is being changed, keep it
+        // within the node until the version check throws the read away.
+        size_t n = __atomic_load_n(&p->n, __ATOMIC_RELAXED);
+        size_t full = p->leaf ? t->_leaf_max : t->_inner_max;
+        return n < full ? n : full;
+}
+
+static inline size_t
+_btree_olc_find(struct btree_olc* t, struct _btree_olc_node* p, void* key,
+                int (*cmp)(void*, void*))
+{
+        return search_lower_bound(_btree_olc_key(t, p, 0),
+                                  _btree_olc_keyno(t, p), t->_key_size, key,
+                                  cmp);
+}
+
+static inline size_t
+_btree_olc_route(struct btree_olc* t, struct _btree_olc_node* p, void* key,
+                 int (*cmp)(void*, void*))
+{
+        // Separators are the first key of their right subtree, so keys equal
+        // to one go right.
+        size_t i = _btree_olc_find(t, p, key, cmp);
+        return i
+               + (i < _btree_olc_keyno(t, p)
+                  && cmp(key, _btree_olc_key(t, p, i)) == 0);
+}
+
+static inline bool
+_btree_olc_read_lock(struct _btree_olc_node* p, uint64_t* version)
+{
+        *version = __atomic_load_n(&p->version, __ATOMIC_ACQUIRE);
+        return (*version & 2) == 0;
+}
+
+static inline bool
+_btree_olc_check(struct _btree_olc_node* p, uint64_t version)
+{
+        // Orders the optimistic reads before the version they are checked
+        // against.
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        return __atomic_load_n(&p->version, __ATOMIC_RELAXED) == version;
+}
+
+static inline bool
+_btree_olc_upgrade(struct _btree_olc_node* p, uint64_t version)
+{
+        // Locks the node only if nobody wrote to it since it was read.
+        return __atomic_compare_exchange_n(&p->version, &version, version + 2,
+                                           false, __ATOMIC_ACQUIRE,
+                                           __ATOMIC_RELAXED);
+}
+
+static inline void
+_btree_olc_unlock(struct _btree_olc_node* p)
+{
+        __atomic_fetch_add(&p->version, 2, __ATOMIC_RELEASE);
+}
+
+static inline struct _btree_olc_node*
+_btree_olc_root(struct btree_olc* t, uint64_t* version)
+{
+        // Locks the root optimistically, as long as it is still the root
+        // after reading its version.
+        struct _btree_olc_node* p;
+        do
+        {
+                p = __atomic_load_n(&t->_root, __ATOMIC_ACQUIRE);
+        } while (!_btree_olc_read_lock(p, version)
+                 || p != __atomic_load_n(&t->_root, __ATOMIC_ACQUIRE));
+        return p;
+}
+
+static struct _btree_olc_node*
+_btree_olc_leaf(struct btree_olc* t, void* key, int (*cmp)(void*, void*),
+                uint64_t* version)
+{
+        // Descends to the leaf of a key, coupling the optimistic locks: a
+        // child is only trusted once its parent is known to be unchanged.
+        struct _btree_olc_node* p;
+        uint64_t v;
+
+restart:
+        p = _btree_olc_root(t, &v);
+        while (!p->leaf)
+        {
+                size_t i = _btree_olc_route(t, p, key, cmp);
+                struct _btree_olc_node* child = *_btree_olc_child(t, p, i);
+                uint64_t child_v;
+                if (!_btree_olc_check(p, v)
+                    || !_btree_olc_read_lock(child, &child_v)
+                    || !_btree_olc_check(p, v))
+                {
+                        goto restart;
+                }
+                p = child;
+                v = child_v;
+        }
+
+        *version = v;
+        return p;
+}
+
+/**
+ * @brief Finds a key on the tree and copies its value, if it exists.
+ *
+ * Other threads **may** change the tree meanwhile, so the value is copied out
+ * instead of returning a handle to it. The comparator receives a pointer to
+ * the given key, and a pointer to the key being compared, respectively. It
+ * **may** be called on keys being overwritten, whose results are discarded.
+ *
+ * @param t Handle to the tree.
+ * @param key Handle to the key to search for.
+ * @param value Where to copy the value to.
+ * @param cmp Search comparator.
+ * @return Whether or not the key was found.
+ */
+bool
+btree_olc_search(struct btree_olc* t, void* key, void* value,
+                 int (*cmp)(void*, void*))
+{
+        while (true)
+        {
+                uint64_t v;
+                struct _btree_olc_node* p = _btree_olc_leaf(t, key, cmp, &v);
+
+                size_t i = _btree_olc_find(t, p, key, cmp);
+                bool found = i < _btree_olc_keyno(t, p)
+                             && cmp(key, _btree_olc_key(t, p, i)) == 0;
+                if (found)
+                {
+                        memcpy(value, _btree_olc_val(t, p, i), t->_val_size);
+                }
+
+                if (_btree_olc_check(p, v))
+                {
+                        return found;
+                }
+        }
+}
+
+/**
+ * @brief Inserts an entry into the tree.
+ *
+ * Finds the appropriate position and inserts the key-value pair while
+ * preserving the B-tree properties. If the key is already on the tree, its
+ * value is replaced instead. The comparator receives a pointer to the given
+ * key, and a pointer to the key being compared, respectively.
+ *
+ * @param t Handle to the tree.
+ * @param key Handle to the key to insert.
+ * @param value Handle to the value to insert.
+ * @param cmp Insertion comparator.
+ */
+void
+btree_olc_insert(struct btree_olc* t, void* key, void* value,
+                 int (*cmp)(void*, void*))
+{
+        struct _btree_olc_node* parent;
+        struct _btree_olc_node* p;
+        uint64_t parent_v;
+        uint64_t v;
+        size_t i;
+
+restart:
+        parent = NULL;
+        p = _btree_olc_root(t, &v);
+        while (true)
+        {
+                size_t full = p->leaf ? t->_leaf_max : t->_inner_max;
+                if (_btree_olc_keyno(t, p) == full)
+                {
+                        // Split on the way down, so the parent always has
+                        // room for the separator. Lock both, as long as
+                        // neither changed since it was read.
+                        if (parent != NULL
+                            && !_btree_olc_upgrade(parent, parent_v))
+                        {
+                                goto restart;
+                        }
+                        if (!_btree_olc_upgrade(p, v))
+                        {
+                                if (parent != NULL)
+                                {
+                                        _btree_olc_unlock(parent);
+                                }
+                                goto restart;
+                        }
+                        if (parent == NULL && p != t->_root)
+                        {
+                                // Another thread grew the tree meanwhile.
+                                _btree_olc_unlock(p);
+                                goto restart;
+                        }
+
+                        _btree_olc_split(t, parent, i, p);
+
+                        _btree_olc_unlock(p);
+                        if (parent != NULL)
+                        {
+                                _btree_olc_unlock(parent);
+                        }
+                        goto restart;
+                }
+                if (parent != NULL && !_btree_olc_check(parent, parent_v))
+                {
+                        goto restart;
+                }
+                if (p->leaf)
+                {
+                        break;
+                }
+
+                i = _btree_olc_route(t, p, key, cmp);
+                struct _btree_olc_node* child = *_btree_olc_child(t, p, i);
+                if (!_btree_olc_check(p, v))
+                {
+                        goto restart;
+                }
+                parent = p;
+                parent_v = v;
+                p = child;
+                if (!_btree_olc_read_lock(p, &v)
+                    || !_btree_olc_check(parent, parent_v))
+                {
+                        goto restart;
+                }
+        }
+
+        if (!_btree_olc_upgrade(p, v))
+        {
+                goto restart;
+        }
+
+        i = _btree_olc_find(t, p, key, cmp);
+        if (i < p->n && cmp(key, _btree_olc_key(t, p, i)) == 0)
+        {
+                memcpy(_btree_olc_val(t, p, i), value, t->_val_size);
+        }
+        else
+        {
+                memmove(_btree_olc_key(t, p, i + 1), _btree_olc_key(t, p, i),
+                        (p->n - i) * t->_key_size);
+                memmove(_btree_olc_val(t, p, i + 1), _btree_olc_val(t, p, i),
+                        (p->n - i) * t->_val_size);
+                memcpy(_btree_olc_key(t, p, i), key, t->_key_size);
+                memcpy(_btree_olc_val(t, p, i), value, t->_val_size);
+                ++p->n;
+        }
+        _btree_olc_unlock(p);
+}
+
+/**
+ * @brief Finds and deletes an entry from the tree.
+ *
+ * Deletes the given key and its associated value from the tree, if it exists.
+ * Does not change the tree if the key doesn't exist. The comparator receives a
+ * pointer to the given key, and a pointer to the key being compared,
+ * respectively.
+ *
+ * @param t Handle to the tree.
+ * @param key Handle to the key to delete.
+ * @param cmp Deletion comparator.
+ * @return Whether or not the value was on the original tree.
+ */
+bool
+btree_olc_remove(struct btree_olc* t, void* key, int (*cmp)(void*, void*))
+{
+        while (true)
+        {
+                uint64_t v;
+                struct _btree_olc_node* p = _btree_olc_leaf(t, key, cmp, &v);
+                if (!_btree_olc_upgrade(p, v))
+                {
+                        continue;
+                }
+
+                size_t i = _btree_olc_find(t, p, key, cmp);
+                bool found
+                    = i < p->n && cmp(key, _btree_olc_key(t, p, i)) == 0;
+                if (found)
+                {
+                        memmove(_btree_olc_key(t, p, i),
+                                _btree_olc_key(t, p, i + 1),
+                                (p->n - i - 1) * t->_key_size);
+                        memmove(_btree_olc_val(t, p, i),
+                                _btree_olc_val(t, p, i + 1),
+                                (p->n - i - 1) * t->_val_size);
+                        --p->n;
+                }
+                _btree_olc_unlock(p);
+
+                return found;
+        }
+}
+
+static struct _btree_olc_node*
+_btree_olc_node(struct btree_olc* t, bool leaf)
+{
+        // The maxima are clamped, so the size comes from them rather than
+        // from the number of lines.
+        size_t size = leaf ? sizeof(struct _btree_olc_node)
+                                 + t->_leaf_max
+                                       * (t->_key_size + t->_val_size)
+                           : _btree_olc_children(t)
+                                 + (t->_inner_max + 1)
+                                       * sizeof(struct _btree_olc_node*);
+        size = (size + _BTREE_OLC_CACHE_LINE - 1)
+               & ~(_BTREE_OLC_CACHE_LINE - 1);
+
+        void* node;
+        if (posix_memalign(&node, _BTREE_OLC_CACHE_LINE, size) != 0)
+        {
+                return NULL;
+        }
+        struct _btree_olc_node* p = node;
+
+        p->version = 0;
+        p->n = 0;
+        p->leaf = leaf;
+
+        return p;
+}
+
+static void
+_btree_olc_free(struct btree_olc* t, struct _btree_olc_node* p)
+{
+        if (!p->leaf)
+        {
+                for (size_t i = 0; i <= p->n; ++i)
+                {
+                        _btree_olc_free(t, *_btree_olc_child(t, p, i));
+                }
+        }
+        free(p);
+}
+
+static void
+_btree_olc_split(struct btree_olc* t, struct _btree_olc_node* parent,
+                 size_t i, struct _btree_olc_node* p)
+{
+        // Invariant: p is full and locked, and so is its parent (the i-th
+        // child of which is p), unless p is the root.
+        struct _btree_olc_node* right = _btree_olc_node(t, p->leaf);
+        size_t key_size = t->_key_size;
+        byte sep[key_size];
+
+        if (p->leaf)
+        {
+                // The separator is copied up, it stays as the first key of
+                // the right leaf.
+                size_t mid = t->_leaf_max / 2;
+                right->n = t->_leaf_max - mid;
+                memcpy(_btree_olc_key(t, right, 0), _btree_olc_key(t, p, mid),
+                       right->n * key_size);
+                memcpy(_btree_olc_val(t, right, 0), _btree_olc_val(t, p, mid),
+                       right->n * t->_val_size);
+                memcpy(sep, _btree_olc_key(t, p, mid), key_size);
+                p->n = mid;
+        }
+        else
+        {
+                // The separator is moved up.
+                size_t mid = t->_inner_max / 2;
+                right->n = t->_inner_max - mid - 1;
+                memcpy(_btree_olc_key(t, right, 0),
+                       _btree_olc_key(t, p, mid + 1), right->n * key_size);
+                memcpy(_btree_olc_child(t, right, 0),
+                       _btree_olc_child(t, p, mid + 1),
+                       (right->n + 1) * sizeof(struct _btree_olc_node*));
+                memcpy(sep, _btree_olc_key(t, p, mid), key_size);
+                p->n = mid;
+        }
+
+        if (parent == NULL)
+        {
+                // Readers only get to the new root once it is complete.
+                struct _btree_olc_node* root = _btree_olc_node(t, false);
+                memcpy(_btree_olc_key(t, root, 0), sep, key_size);
+                *_btree_olc_child(t, root, 0) = p;
+                *_btree_olc_child(t, root, 1) = right;
+                root->n = 1;
+                __atomic_store_n(&t->_root, root, __ATOMIC_RELEASE);
+                return;
+        }
+
+        memmove(_btree_olc_key(t, parent, i + 1), _btree_olc_key(t, parent, i),
+                (parent->n - i) * key_size);
+        memmove(_btree_olc_child(t, parent, i + 2),
+                _btree_olc_child(t, parent, i + 1),
+                (parent->n - i) * sizeof(struct _btree_olc_node*));
+        memcpy(_btree_olc_key(t, parent, i), sep, key_size);
+        *_btree_olc_child(t, parent, i + 1) = right;
+        ++parent->n;
+}
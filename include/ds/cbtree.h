@@ -0,0 +1,589 @@
+#pragma once
+#pragma icanc include
+#include <leet.h>
+#include <alg/search.h>
+#pragma icanc end
+
+#include <stdint.h>
+
+/**
+ * @file cbtree.h
+ *
+ * `#include <ds/cbtree.h>`
+ *
+ * A cache-line-aware B-tree. Each node of a @ref btree is spread over seven
+ * allocations (the node, three slice handles and three arrays), so a lookup
+ * can touch seven unrelated blocks of memory per level. A cbtree node is a
+ * single cache-line-aligned block holding its key count, keys, values and
+ * children inline, and nodes are sized in cache lines instead of bytes per
+ * array. Leaves have no children and are allocated without the children
+ * array.
+ *
+ * The API mirrors the @ref btree API, so the two **may** be swapped for one
+ * another.
+ */
+
+/**
+ * @brief Size of a cache line in bytes. Nodes are aligned to and sized in
+ * multiples of this.
+ */
+#define _CBTREE_CACHE_LINE 64
+
+/**
+ * @brief Number of cache lines on the internal nodes of a tree created by
+ * @ref cbtree_create.
+ * @see cbtree_create_lines
+ */
+#define _CBTREE_LINES 4
+
+/**
+ * @brief A node in a cache-line-aware B-tree.
+ *
+ * Only the header of the node is described by the struct. The keys, values
+ * and children are stored inline right after it, at offsets computed when the
+ * tree is created.
+ */
+struct cbtree
+{
+        uint32_t _n;        ///< Number of keys on the node.
+        uint16_t _t;        ///< Degree of the tree.
+        uint16_t _key_size; ///< Size of each key in bytes.
+        uint16_t _val_size; ///< Size of each value in bytes.
+        uint16_t _values;   ///< Offset of the values from the node, in bytes.
+        uint16_t _children; ///< Offset of the children from the node.
+        bool _leaf;         ///< Whether the node has no children.
+};
+
+static size_t _cbtree_values(size_t key_size, size_t t);
+static size_t _cbtree_children(size_t key_size, size_t val_size, size_t t);
+static struct cbtree* _cbtree_node(size_t key_size, size_t val_size, size_t t,
+                                   bool leaf);
+static void _cbtree_split_child(struct cbtree* p, size_t i);
+static bool _cbtree_delete_internal(struct cbtree** p, void* key, size_t i,
+                                    int (*cmp)(void*, void*));
+static bool _cbtree_delete_subtree(struct cbtree** p, void* key, size_t i,
+                                   int (*cmp)(void*, void*));
+
+/**
+ * @brief Initializes a cbtree whose internal nodes span a given number of
+ * cache lines.
+ *
+ * Picks the largest degree for which an internal node (header, keys, values
+ * and children) fits in `lines` cache lines. The degree is never smaller than
+ * 2, so large keys **may** overflow small nodes.
+ *
+ * Every call to cbtree_create_lines **must** have a matching call to
+ * @ref cbtree_destroy to release the managed memory.
+ *
+ * @param key_size Size of each key.
+ * @param val_size Size of each value.
+ * @param lines Number of cache lines per internal node.
+ * @return Handle to the cbtree.
+ */
+struct cbtree*
+cbtree_create_lines(size_t key_size, size_t val_size, size_t lines)
+{
+        size_t entry = key_size + val_size;
+        size_t bytes = lines * _CBTREE_CACHE_LINE;
+
+        // An internal node of degree t takes the header plus 2t - 1 entries
+        // and 2t children, and the values and children are aligned, which
+        // the estimate leaves out.
+        size_t t = (bytes - sizeof(struct cbtree) + entry)
+                   / (2 * (entry + sizeof(struct cbtree*)));
+        t = max(t, 2);
+        while (t > 2
+               && _cbtree_children(key_size, val_size, t)
+                          + 2 * t * sizeof(struct cbtree*)
+                      > bytes)
+        {
+                --t;
+        }
+
+        return _cbtree_node(key_size, val_size, t, true);
+}
+
+/**
+ * @brief Initializes a cbtree.
+ *
+ * Every call to cbtree_create **must** have a matching call to
+ * @ref cbtree_destroy to release the managed memory.
+ *
+ * @param key_size Size of each key.
+ * @param val_size Size of each value.
+ * @return Handle to the cbtree.
+ */
+struct cbtree*
+cbtree_create(size_t key_size, size_t val_size)
+{
+        return cbtree_create_lines(key_size, val_size, _CBTREE_LINES);
+}
+
+/**
+ * @brief Deallocates the memory managed by a cbtree created with
+ * @ref cbtree_create.
+ *
+ * Releases every node on the tree.
+ *
+ * @param p Handle to the cbtree.
+ */
+void
+cbtree_destroy(struct cbtree* p)
+{
+        if (!p->_leaf)
+        {
+                struct cbtree** children
+                    = (struct cbtree**)((byte*)p + p->_children);
+                for (size_t i = 0; i <= p->_n; ++i)
+                {
+                        cbtree_destroy(children[i]);
+                }
+        }
+        free(p);
+}
+
+static inline byte*
+_cbtree_key(struct cbtree* p, size_t idx)
+{
+        return (byte*)p + sizeof(struct cbtree) + idx * p->_key_size;
+}
+
+static inline byte*
+_cbtree_val(struct cbtree* p, size_t idx)
+{
+        return (byte*)p + p->_values + idx * p->_val_size;
+}
+
+static inline struct cbtree**
+_cbtree_child(struct cbtree* p, size_t idx)
+{
+        return (struct cbtree**)((byte*)p + p->_children) + idx;
+}
+
+static inline size_t
+_cbtree_find(struct cbtree* p, void* key, int (*cmp)(void*, void*))
+{
+        return search_lower_bound(_cbtree_key(p, 0), p->_n, p->_key_size, key,
+                                  cmp);
+}
+
+/**
+ * @brief Inserts an entry into the tree.
+ *
+ * Finds the appropriate position and inserts the key-value pair while
+ * preserving the B-tree properties.
+ * The comparator receives a pointer to the given key, and a pointer
+ * to the key being compared, respectively.
+ * **May** update the root pointer.
+ *
+ * @param p Handle to the root of the tree.
+ * @param key Handle to the key to insert.
+ * @param value Handle to the value to insert.
+ * @param cmp Insertion comparator.
+ */
+void
+cbtree_insert(struct cbtree** p, void* key, void* value,
+              int (*cmp)(void*, void*))
+{
+        struct cbtree* x = *p;
+        size_t t = x->_t;
+
+        if (x->_n == 2 * t - 1)
+        {
+                // Parent the root to an empty node and split it.
+                struct cbtree* root
+                    = _cbtree_node(x->_key_size, x->_val_size, t, false);
+                *_cbtree_child(root, 0) = x;
+                _cbtree_split_child(root, 0);
+                *p = x = root;
+        }
+
+        // Invariant: x is not full, so splitting a child has room for the
+        // key it pulls up.
+        while (!x->_leaf)
+        {
+                size_t i = _cbtree_find(x, key, cmp);
+                if ((*_cbtree_child(x, i))->_n == 2 * t - 1)
+                {
+                        _cbtree_split_child(x, i);
+                        // By splitting we just pulled up a key. If it's
+                        // smaller than the one we want to insert, then we have
+                        // to insert after the new key.
+                        if (cmp(key, _cbtree_key(x, i)) > 0)
+                        {
+                                ++i;
+                        }
+                }
+                x = *_cbtree_child(x, i);
+        }
+
+        size_t i = _cbtree_find(x, key, cmp);
+        memmove(_cbtree_key(x, i + 1), _cbtree_key(x, i),
+                (x->_n - i) * x->_key_size);
+        memmove(_cbtree_val(x, i + 1), _cbtree_val(x, i),
+                (x->_n - i) * x->_val_size);
+        memcpy(_cbtree_key(x, i), key, x->_key_size);
+        memcpy(_cbtree_val(x, i), value, x->_val_size);
+        ++x->_n;
+}
+
+/**
+ * @brief Finds a key on the tree and returns a handle to its value, if it
+ * exists.
+ *
+ * Finds the value associated with the given key, if it exists. Returns null
+ * otherwise. The comparator receives a pointer to the given key, and a pointer
+ * to the key being compared, respectively.
+ *
+ * @param p Handle to the tree.
+ * @param key Handle to the key to search for.
+ * @param cmp Search comparator.
+ */
+data*
+cbtree_search(struct cbtree* p, void* key, int (*cmp)(void*, void*))
+{
+        while (true)
+        {
+                size_t i = _cbtree_find(p, key, cmp);
+
+                if (i < p->_n && cmp(key, _cbtree_key(p, i)) == 0)
+                {
+                        return _cbtree_val(p, i);
+                }
+                if (p->_leaf)
+                {
+                        return NULL;
+                }
+                p = *_cbtree_child(p, i);
+        }
+}
+
+/**
+ * @brief Finds and deletes an entry from the tree.
+ *
+ * Deletes the given key and its associated value from the tree, if it exists.
+ * Does not change the tree if the key doesn't exist. The comparator receives a
+ * pointer to the given key, and a pointer to the key being compared,
+ * respectively.
+ * **May** update the root pointer.
+ *
+ * @param p Handle to the root of the tree.
+ * @param key Handle to the key to delete.
+ * @param cmp Deletion comparator.
+ * @return Whether or not the value was on the original tree.
+ */
+bool
+cbtree_remove(struct cbtree** p, void* key, int (*cmp)(void*, void*))
+{
+        struct cbtree* x = *p;
+        size_t i = _cbtree_find(x, key, cmp);
+
+        // The key is on this node.
+        if (i < x->_n && cmp(key, _cbtree_key(x, i)) == 0)
+        {
+                if (x->_leaf)
+                {
+                        memmove(_cbtree_key(x, i), _cbtree_key(x, i + 1),
+                                (x->_n - i - 1) * x->_key_size);
+                        memmove(_cbtree_val(x, i), _cbtree_val(x, i + 1),
+                                (x->_n - i - 1) * x->_val_size);
+                        --x->_n;
+                        return true;
+                }
+                return _cbtree_delete_internal(p, key, i, cmp);
+        }
+
+        // The key is not on this node ...
+        // ... but it could be in the subtree rooted at the ith child.
+        if (!x->_leaf)
+        {
+                return _cbtree_delete_subtree(p, key, i, cmp);
+        }
+        // ... and this is a leaf. The key is not on the tree.
+        return false;
+}
+
+static inline size_t
+_cbtree_align(size_t size)
+{
+        // Rounds up to the alignment of size_t, so values and children can
+        // be read in place.
+        return (size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+}
+
+static inline size_t
+_cbtree_values(size_t key_size, size_t t)
+{
+        return _cbtree_align(sizeof(struct cbtree) + (2 * t - 1) * key_size);
+}
+
+static inline size_t
+_cbtree_children(size_t key_size, size_t val_size, size_t t)
+{
+        return _cbtree_align(_cbtree_values(key_size, t)
+                             + (2 * t - 1) * val_size);
+}
+
+static struct cbtree*
+_cbtree_node(size_t key_size, size_t val_size, size_t t, bool leaf)
+{
+        size_t values = _cbtree_values(key_size, t);
+        size_t children = _cbtree_children(key_size, val_size, t);
+
+        size_t size = children;
+        if (!leaf)
+        {
+                size += 2 * t * sizeof(struct cbtree*);
+        }
+        size = (size + _CBTREE_CACHE_LINE - 1) & ~(_CBTREE_CACHE_LINE - 1);
+        assert(children <= UINT16_MAX && t <= UINT16_MAX);
+
+        void* node;
+        if (posix_memalign(&node, _CBTREE_CACHE_LINE, size) != 0)
+        {
+                return NULL;
+        }
+        struct cbtree* p = node;
+
+        p->_n = 0;
+        p->_t = t;
+        p->_key_size = key_size;
+        p->_val_size = val_size;
+        p->_values = values;
+        p->_children = children;
+        p->_leaf = leaf;
+
+        return p;
+}
+
+static void
+_cbtree_split_child(struct cbtree* p, size_t i)
+{
+        // Invariant: the i-th child is full and p is not.
+        size_t t = p->_t;
+        struct cbtree* child = *_cbtree_child(p, i);
+        struct cbtree* sibling
+            = _cbtree_node(p->_key_size, p->_val_size, t, child->_leaf);
+
+        // Move the t - 1 entries after the median, and their t children, to
+        // the new node.
+        memcpy(_cbtree_key(sibling, 0), _cbtree_key(child, t),
+               (t - 1) * p->_key_size);
+        memcpy(_cbtree_val(sibling, 0), _cbtree_val(child, t),
+               (t - 1) * p->_val_size);
+        if (!child->_leaf)
+        {
+                memcpy(_cbtree_child(sibling, 0), _cbtree_child(child, t),
+                       t * sizeof(struct cbtree*));
+        }
+        sibling->_n = t - 1;
+
+        // Make room on the parent for the median and the new node.
+        memmove(_cbtree_key(p, i + 1), _cbtree_key(p, i),
+                (p->_n - i) * p->_key_size);
+        memmove(_cbtree_val(p, i + 1), _cbtree_val(p, i),
+                (p->_n - i) * p->_val_size);
+        memmove(_cbtree_child(p, i + 2), _cbtree_child(p, i + 1),
+                (p->_n - i) * sizeof(struct cbtree*));
+
+        // Pull the median up.
+        memcpy(_cbtree_key(p, i), _cbtree_key(child, t - 1), p->_key_size);
+        memcpy(_cbtree_val(p, i), _cbtree_val(child, t - 1), p->_val_size);
+        *_cbtree_child(p, i + 1) = sibling;
+        ++p->_n;
+
+        child->_n = t - 1;
+}
+
+static struct cbtree**
+_cbtree_merge(struct cbtree** root, size_t idx)
+{
+        struct cbtree* parent = *root;
+        struct cbtree* target = *_cbtree_child(parent, idx);
+        struct cbtree* victim = *_cbtree_child(parent, idx + 1);
+        size_t n = target->_n;
+
+        // Merge the key ...
+        memcpy(_cbtree_key(target, n), _cbtree_key(parent, idx),
+               parent->_key_size);
+        memcpy(_cbtree_val(target, n), _cbtree_val(parent, idx),
+               parent->_val_size);
+
+        // ... and the next child into the previous child.
+        memcpy(_cbtree_key(target, n + 1), _cbtree_key(victim, 0),
+               victim->_n * parent->_key_size);
+        memcpy(_cbtree_val(target, n + 1), _cbtree_val(victim, 0),
+               victim->_n * parent->_val_size);
+        if (!victim->_leaf)
+        {
+                memcpy(_cbtree_child(target, n + 1), _cbtree_child(victim, 0),
+                       (victim->_n + 1) * sizeof(struct cbtree*));
+        }
+        target->_n = n + 1 + victim->_n;
+
+        // Delete the key and the child we merged.
+        memmove(_cbtree_key(parent, idx), _cbtree_key(parent, idx + 1),
+                (parent->_n - idx - 1) * parent->_key_size);
+        memmove(_cbtree_val(parent, idx), _cbtree_val(parent, idx + 1),
+                (parent->_n - idx - 1) * parent->_val_size);
+        memmove(_cbtree_child(parent, idx + 1), _cbtree_child(parent, idx + 2),
+                (parent->_n - idx - 1) * sizeof(struct cbtree*));
+        --parent->_n;
+        free(victim);
+
+        if (parent->_n == 0)
+        {
+                // The previous root is now empty, promote the child.
+                *root = target;
+                free(parent);
+                return root;
+        }
+        return _cbtree_child(parent, idx);
+}
+
+static void
+_cbtree_steal_prev(struct cbtree* parent, size_t idx)
+{
+        struct cbtree* curr = *_cbtree_child(parent, idx);
+        struct cbtree* prev = *_cbtree_child(parent, idx - 1);
+
+        // Move the key from the parent down into the front of the child.
+        memmove(_cbtree_key(curr, 1), _cbtree_key(curr, 0),
+                curr->_n * curr->_key_size);
+        memmove(_cbtree_val(curr, 1), _cbtree_val(curr, 0),
+                curr->_n * curr->_val_size);
+        memcpy(_cbtree_key(curr, 0), _cbtree_key(parent, idx - 1),
+               curr->_key_size);
+        memcpy(_cbtree_val(curr, 0), _cbtree_val(parent, idx - 1),
+               curr->_val_size);
+
+        // Turn the last child of the previous node into the first child of
+        // the child.
+        if (!curr->_leaf)
+        {
+                memmove(_cbtree_child(curr, 1), _cbtree_child(curr, 0),
+                        (curr->_n + 1) * sizeof(struct cbtree*));
+                *_cbtree_child(curr, 0) = *_cbtree_child(prev, prev->_n);
+        }
+        ++curr->_n;
+
+        // Move the last key of the previous node up to the parent.
+        memcpy(_cbtree_key(parent, idx - 1), _cbtree_key(prev, prev->_n - 1),
+               parent->_key_size);
+        memcpy(_cbtree_val(parent, idx - 1), _cbtree_val(prev, prev->_n - 1),
+               parent->_val_size);
+        --prev->_n;
+}
+
+static void
+_cbtree_steal_next(struct cbtree* parent, size_t idx)
+{
+        struct cbtree* curr = *_cbtree_child(parent, idx);
+        struct cbtree* next = *_cbtree_child(parent, idx + 1);
+
+        // Move the key from the parent down into the back of the child.
+        memcpy(_cbtree_key(curr, curr->_n), _cbtree_key(parent, idx),
+               curr->_key_size);
+        memcpy(_cbtree_val(curr, curr->_n), _cbtree_val(parent, idx),
+               curr->_val_size);
+
+        // Turn the first child of the next node into the last child of the
+        // child.
+        if (!curr->_leaf)
+        {
+                *_cbtree_child(curr, curr->_n + 1) = *_cbtree_child(next, 0);
+                memmove(_cbtree_child(next, 0), _cbtree_child(next, 1),
+                        next->_n * sizeof(struct cbtree*));
+        }
+        ++curr->_n;
+
+        // Move the first key of the next node up to the parent.
+        memcpy(_cbtree_key(parent, idx), _cbtree_key(next, 0),
+               parent->_key_size);
+        memcpy(_cbtree_val(parent, idx), _cbtree_val(next, 0),
+               parent->_val_size);
+        memmove(_cbtree_key(next, 0), _cbtree_key(next, 1),
+                (next->_n - 1) * next->_key_size);
+        memmove(_cbtree_val(next, 0), _cbtree_val(next, 1),
+                (next->_n - 1) * next->_val_size);
+        --next->_n;
+}
+
+static bool
+_cbtree_delete_internal(struct cbtree** p, void* key, size_t i,
+                        int (*cmp)(void*, void*))
+{
+        struct cbtree* x = *p;
+        struct cbtree** prev_child = _cbtree_child(x, i);
+        struct cbtree** next_child = _cbtree_child(x, i + 1);
+
+        if ((*prev_child)->_n >= x->_t)
+        {
+                // Replace the key with its predecessor, then delete the
+                // predecessor from the previous subtree.
+                struct cbtree* pred = *prev_child;
+                while (!pred->_leaf)
+                {
+                        pred = *_cbtree_child(pred, pred->_n);
+                }
+                memcpy(_cbtree_key(x, i), _cbtree_key(pred, pred->_n - 1),
+                       x->_key_size);
+                memcpy(_cbtree_val(x, i), _cbtree_val(pred, pred->_n - 1),
+                       x->_val_size);
+
+                return cbtree_remove(prev_child, _cbtree_key(x, i), cmp);
+        }
+        if ((*next_child)->_n >= x->_t)
+        {
+                // Same with the successor on the next subtree.
+                struct cbtree* succ = *next_child;
+                while (!succ->_leaf)
+                {
+                        succ = *_cbtree_child(succ, 0);
+                }
+                memcpy(_cbtree_key(x, i), _cbtree_key(succ, 0), x->_key_size);
+                memcpy(_cbtree_val(x, i), _cbtree_val(succ, 0), x->_val_size);
+
+                return cbtree_remove(next_child, _cbtree_key(x, i), cmp);
+        }
+
+        // Both children have t - 1 keys, merge them around the key and delete
+        // it from the merged node.
+        return cbtree_remove(_cbtree_merge(p, i), key, cmp);
+}
+
+static bool
+_cbtree_delete_subtree(struct cbtree** p, void* key, size_t i,
+                       int (*cmp)(void*, void*))
+{
+        struct cbtree* x = *p;
+        struct cbtree** subtree = _cbtree_child(x, i);
+
+        // There are enough keys on the subtree.
+        if ((*subtree)->_n >= x->_t)
+        {
+                return cbtree_remove(subtree, key, cmp);
+        }
+
+        // If a sibling has enough keys, steal one.
+        if (i > 0 && (*_cbtree_child(x, i - 1))->_n >= x->_t)
+        {
+                _cbtree_steal_prev(x, i);
+        }
+        else if (i < x->_n && (*_cbtree_child(x, i + 1))->_n >= x->_t)
+        {
+                _cbtree_steal_next(x, i);
+        }
+        // If a sibling also has t - 1 keys, merge.
+        else if (i > 0)
+        {
+                subtree = _cbtree_merge(p, i - 1);
+        }
+        else
+        {
+                subtree = _cbtree_merge(p, i);
+        }
+
+        // Now there are enough keys on the subtree.
+        return cbtree_remove(subtree, key, cmp);
+}
@@ -0,0 +1,308 @@
+#pragma once
+#pragma icanc include
+#include <leet.h>
+#include <ds/slice.h>
+#pragma icanc end
+
+/**
+ * @file deque.h
+ *
+ * `#include <ds/deque.h>`
+ *
+ * A double-ended queue on a ring buffer. Elements live on a slice used as a
+ * circle: the first one **may** be anywhere on it and the rest follow,
+ * wrapping around to the start of the slice. Pushing and popping at either end
+ * moves a single element and never shifts the others, so a deque works both
+ * as a FIFO queue and as a stack.
+ *
+ * Since the elements wrap around, they are not contiguous in general. They
+ * are at most two contiguous runs though, which @ref deque_segments returns
+ * so loops over a deque **may** walk plain arrays.
+ */
+
+/**
+ * @brief Handle to a deque.
+ * @see deque_create
+ */
+struct deque
+{
+        /// @privatesection
+        struct slice* _slots; ///< Every slot, its length is the number of
+                              ///< elements on the deque.
+        size_t _head;         ///< Slot of the first element.
+        size_t _capacity;     ///< Number of slots.
+};
+
+static size_t _deque_slot(struct deque* d, size_t idx);
+static void _deque_grow(struct deque* d);
+
+/**
+ * @brief Initializes a deque.
+ *
+ * Every call to deque_create **must** have a matching call to
+ * @ref deque_destroy to release the managed memory.
+ *
+ * @param el_size Size of each element.
+ * @param el_no Number of elements for the initial allocation.
+ * @return Handle to the deque.
+ */
+struct deque*
+deque_create(size_t el_size, size_t el_no)
+{
+        struct deque* d = malloc(sizeof(struct deque));
+        d->_slots = slice_make(el_size, el_no);
+        d->_head = 0;
+        d->_capacity = el_no;
+
+        return d;
+}
+
+/**
+ * @brief Deallocates the memory managed by a deque created with
+ * @ref deque_create.
+ *
+ * @param d Handle to the deque.
+ */
+void
+deque_destroy(struct deque* d)
+{
+        slice_del(d->_slots);
+        free(d);
+}
+
+/**
+ * @brief Returns the number of elements on the deque.
+ *
+ * @param d Handle to the deque.
+ */
+size_t
+deque_len(struct deque* d)
+{
+        return d->_slots->len;
+}
+
+/**
+ * @brief Returns whether the deque is empty.
+ *
+ * @param d Handle to the deque.
+ */
+bool
+deque_empty(struct deque* d)
+{
+        return d->_slots->len == 0;
+}
+
+/**
+ * @brief Returns a pointer to the element at the given position, counting
+ * from the front.
+ *
+ * *Does not* check the bounds. The pointer is valid until the deque grows.
+ *
+ * @param d Handle to the deque.
+ * @param idx Position of the element, 0 being the front.
+ */
+data*
+deque_at(struct deque* d, size_t idx)
+{
+        return slice_at(d->_slots, _deque_slot(d, idx));
+}
+
+/**
+ * @brief Returns the first element of the deque.
+ *
+ * **Does not** check if the deque is empty.
+ *
+ * @param d Handle to the deque.
+ */
+data*
+deque_front(struct deque* d)
+{
+        return slice_at(d->_slots, d->_head);
+}
+
+/**
+ * @brief Returns the last element of the deque.
+ *
+ * **Does not** check if the deque is empty.
+ *
+ * @param d Handle to the deque.
+ */
+data*
+deque_back(struct deque* d)
+{
+        return deque_at(d, d->_slots->len - 1);
+}
+
+/**
+ * @brief Appends a value to the back of the deque.
+ *
+ * Grows the deque if it is full, following the growth policy of its slice.
+ * @see slice_resize
+ *
+ * @param d Handle to the deque.
+ * @param el Pointer to the element to append.
+ */
+void
+deque_push_back(struct deque* d, data* el)
+{
+        if (d->_slots->len == d->_capacity)
+        {
+                _deque_grow(d);
+        }
+
+        ++d->_slots->len;
+        slice_replace(d->_slots, el, _deque_slot(d, d->_slots->len - 1));
+}
+
+/**
+ * @brief Prepends a value to the front of the deque.
+ *
+ * Grows the deque if it is full, following the growth policy of its slice.
+ * @see slice_resize
+ *
+ * @param d Handle to the deque.
+ * @param el Pointer to the element to prepend.
+ */
+void
+deque_push_front(struct deque* d, data* el)
+{
+        if (d->_slots->len == d->_capacity)
+        {
+                _deque_grow(d);
+        }
+
+        d->_head = d->_head == 0 ? d->_capacity - 1 : d->_head - 1;
+        ++d->_slots->len;
+        slice_replace(d->_slots, el, d->_head);
+}
+
+/**
+ * @brief Removes the last element of the deque.
+ *
+ * @param d Handle to the deque.
+ * @param out Where to copy the element to, or null to discard it.
+ * @return Whether or not there was an element to remove.
+ */
+bool
+deque_pop_back(struct deque* d, data* out)
+{
+        if (deque_empty(d))
+        {
+                return false;
+        }
+
+        struct _slice* h = (struct _slice*)d->_slots;
+        if (out != NULL)
+        {
+                memcpy(out, deque_back(d), h->el_size);
+        }
+        --h->len;
+
+        return true;
+}
+
+/**
+ * @brief Removes the first element of the deque.
+ *
+ * @param d Handle to the deque.
+ * @param out Where to copy the element to, or null to discard it.
+ * @return Whether or not there was an element to remove.
+ */
+bool
+deque_pop_front(struct deque* d, data* out)
+{
+        if (deque_empty(d))
+        {
+                return false;
+        }
+
+        struct _slice* h = (struct _slice*)d->_slots;
+        if (out != NULL)
+        {
+                memcpy(out, deque_front(d), h->el_size);
+        }
+        d->_head = _deque_slot(d, 1);
+        --h->len;
+
+        return true;
+}
+
+/**
+ * @brief Removes every element from the deque.
+ *
+ * @param d Handle to the deque.
+ */
+void
+deque_clear(struct deque* d)
+{
+        d->_slots->len = 0;
+        d->_head = 0;
+}
+
+/**
+ * @brief Returns the elements of the deque as two contiguous runs.
+ *
+ * The elements of `first` followed by the ones of `second` are the elements
+ * of the deque from front to back. `second` is empty unless the elements wrap
+ * around the end of the ring. Both are views into the deque, valid until it
+ * changes.
+ *
+ * ```c
+ * struct slice first, second;
+ * deque_segments(d, &first, &second);
+ * for (size_t i = 0; i < first.len; ++i)
+ *         sum += ((int*)first.data)[i];
+ * for (size_t i = 0; i < second.len; ++i)
+ *         sum += ((int*)second.data)[i];
+ * ```
+ *
+ * @param d Handle to the deque.
+ * @param first Set to the run starting at the front.
+ * @param second Set to the run ending at the back.
+ */
+void
+deque_segments(struct deque* d, struct slice* first, struct slice* second)
+{
+        size_t len = d->_slots->len;
+        size_t head_run = d->_capacity - d->_head;
+        if (head_run > len)
+        {
+                head_run = len;
+        }
+
+        first->data = slice_at(d->_slots, d->_head);
+        first->len = head_run;
+        second->data = d->_slots->data;
+        second->len = len - head_run;
+}
+
+static inline size_t
+_deque_slot(struct deque* d, size_t idx)
+{
+        // Capacity follows the growth policy of the slice and need not be a
+        // power of 2, so wrap with a compare instead of a mask.
+        size_t slot = d->_head + idx;
+        return slot >= d->_capacity ? slot - d->_capacity : slot;
+}
+
+static void
+_deque_grow(struct deque* d)
+{
+        // Only called when full, so the slice length covers every slot and
+        // the whole ring survives the reallocation. If the ring wraps, the
+        // run from the head to the old end moves to the new end, which keeps
+        // it in order.
+        struct _slice* h = (struct _slice*)d->_slots;
+        size_t capacity = d->_capacity;
+        slice_resize(d->_slots);
+        d->_capacity = h->capacity / h->el_size;
+
+        if (d->_head > 0)
+        {
+                size_t head_run = capacity - d->_head;
+                size_t new_head = d->_capacity - head_run;
+                memmove(slice_at(d->_slots, new_head),
+                        slice_at(d->_slots, d->_head), head_run * h->el_size);
+                d->_head = new_head;
+        }
+}
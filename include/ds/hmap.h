@@ -0,0 +1,398 @@
+#pragma once
+#pragma icanc include
+#include <leet.h>
+#include <ds/slice.h>
+#pragma icanc end
+
+#include <stdint.h>
+
+/**
+ * @file hmap.h
+ *
+ * `#include <ds/hmap.h>`
+ *
+ * A hash map with open addressing. Entries are stored inline on a slice of
+ * slots, so a lookup usually reads one or two adjacent slots instead of
+ * chasing pointers down a tree.
+ *
+ * Collisions are resolved with linear probing and
+ * [Robin Hood hashing](https://programming.guide/robin-hood-hashing.html):
+ * an entry that is further from the slot it hashed to than the one in its way
+ * takes that slot, and the displaced entry moves on instead. Probe lengths
+ * stay short even on full tables, and a search for a missing key stops as
+ * soon as it meets an entry closer to home than itself. Removals shift the
+ * entries after the removed one back, so no tombstones are left behind.
+ */
+
+/**
+ * @brief Load factor (in eighths) past which a map doubles its slots.
+ */
+#define _HMAP_MAX_LOAD 7
+
+/**
+ * @brief Number of slots on a new map.
+ */
+#define _HMAP_MIN_SLOTS 8
+
+/**
+ * @brief Header of a slot on a map.
+ *
+ * The key is stored right after it, followed by the value.
+ */
+struct _hmap_slot
+{
+        uint32_t dist; ///< Distance from the slot the key hashed to, plus 1,
+                       ///< or 0 if the slot is empty.
+        uint32_t tag;  ///< High bits of the hash, to skip most comparisons.
+};
+
+/**
+ * @brief Handle to a hash map.
+ * @see hmap_create
+ */
+struct hmap
+{
+        /// @privatesection
+        struct slice* _slots; ///< Every slot, empty or not.
+        size_t _n;            ///< Number of entries.
+        size_t _key_size;     ///< Size of each key.
+        size_t _val_size;     ///< Size of each value.
+        size_t _val_offset;   ///< Offset of the value on a slot.
+        size_t (*_hash)(data*, size_t); ///< Hashes a key of the given size.
+        int (*_cmp)(data*, data*);      ///< Compares keys, or null.
+        byte* _tmp;                     ///< Room for two slots, for swaps.
+};
+
+data* hmap_search(struct hmap* m, data* key);
+static size_t _hmap_align(size_t size);
+static size_t _hmap_slot_size(struct hmap* m);
+static struct _hmap_slot* _hmap_at(struct hmap* m, size_t idx);
+static bool _hmap_eq(struct hmap* m, data* key, struct _hmap_slot* s);
+static void _hmap_grow(struct hmap* m);
+
+/**
+ * @brief Hashes a key as a string of bytes.
+ *
+ * [FNV-1a](https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function)
+ * followed by the finalizer of MurmurHash3, so every bit of the key reaches
+ * the low bits that pick a slot. Works for any key without padding.
+ *
+ * @param key Pointer to the key.
+ * @param key_size Size of the key.
+ * @return Hash of the key.
+ */
+size_t
+hmap_hash_bytes(data* key, size_t key_size)
+{
+        uint64_t h = 0xcbf29ce484222325;
+        for (size_t i = 0; i < key_size; ++i)
+        {
+                h = (h ^ ((byte*)key)[i]) * 0x100000001b3;
+        }
+
+        h = (h ^ (h >> 33)) * 0xff51afd7ed558ccd;
+        h = (h ^ (h >> 33)) * 0xc4ceb9fe1a85ec53;
+        return h ^ (h >> 33);
+}
+
+/**
+ * @brief Hashes an integer key of up to 8 bytes.
+ *
+ * Loads the key as a single word and mixes it with the finalizer of
+ * MurmurHash3, which is much cheaper than hashing it byte by byte.
+ *
+ * @param key Pointer to the key.
+ * @param key_size Size of the key: 1, 2, 4 or 8.
+ * @return Hash of the key.
+ */
+size_t
+hmap_hash_int(data* key, size_t key_size)
+{
+        // Fixed-size copies compile to a single load, a copy of key_size
+        // bytes would be a call.
+        uint8_t k8;
+        uint16_t k16;
+        uint32_t k32;
+        uint64_t h;
+        switch (key_size)
+        {
+        case sizeof(uint8_t):
+                memcpy(&k8, key, sizeof(k8));
+                h = k8;
+                break;
+        case sizeof(uint16_t):
+                memcpy(&k16, key, sizeof(k16));
+                h = k16;
+                break;
+        case sizeof(uint32_t):
+                memcpy(&k32, key, sizeof(k32));
+                h = k32;
+                break;
+        default:
+                memcpy(&h, key, sizeof(h));
+                break;
+        }
+
+        h = (h ^ (h >> 33)) * 0xff51afd7ed558ccd;
+        h = (h ^ (h >> 33)) * 0xc4ceb9fe1a85ec53;
+        return h ^ (h >> 33);
+}
+
+/**
+ * @brief Initializes a hash map.
+ *
+ * Every call to hmap_create **must** have a matching call to
+ * @ref hmap_destroy to release the managed memory. Keys that compare equal
+ * **must** have the same hash.
+ *
+ * @param key_size Size of each key.
+ * @param val_size Size of each value.
+ * @param hash Hashes a key given its size, or null for
+ * @ref hmap_hash_bytes.
+ * @param cmp Returns 0 if both keys are equal, or null to compare their
+ * bytes.
+ * @return Handle to the map.
+ */
+struct hmap*
+hmap_create(size_t key_size, size_t val_size, size_t (*hash)(data*, size_t),
+            int (*cmp)(data*, data*))
+{
+        struct hmap* m = malloc(sizeof(struct hmap));
+
+        m->_n = 0;
+        m->_key_size = key_size;
+        m->_val_size = val_size;
+        m->_val_offset = _hmap_align(sizeof(struct _hmap_slot) + key_size);
+        m->_hash = hash != NULL ? hash : hmap_hash_bytes;
+        m->_cmp = cmp;
+        m->_tmp = malloc(2 * _hmap_slot_size(m));
+
+        m->_slots = slice_make(_hmap_slot_size(m), _HMAP_MIN_SLOTS);
+        memset(m->_slots->data, 0, _HMAP_MIN_SLOTS * _hmap_slot_size(m));
+        m->_slots->len = _HMAP_MIN_SLOTS;
+
+        return m;
+}
+
+/**
+ * @brief Deallocates the memory managed by a map created with
+ * @ref hmap_create.
+ *
+ * @param m Handle to the map.
+ */
+void
+hmap_destroy(struct hmap* m)
+{
+        slice_del(m->_slots);
+        free(m->_tmp);
+        free(m);
+}
+
+/**
+ * @brief Returns the number of entries on the map.
+ *
+ * @param m Handle to the map.
+ */
+size_t
+hmap_len(struct hmap* m)
+{
+        return m->_n;
+}
+
+/**
+ * @brief Inserts an entry into the map.
+ *
+ * If the key is already on the map, its value is replaced instead. Doubles
+ * the slots when a new key would take the map over @ref _HMAP_MAX_LOAD
+ * eighths full, which invalidates handles to values on the map.
+ *
+ * @param m Handle to the map.
+ * @param key Handle to the key to insert.
+ * @param value Handle to the value to insert.
+ */
+void
+hmap_insert(struct hmap* m, data* key, data* value)
+{
+        if ((m->_n + 1) * 8 > m->_slots->len * _HMAP_MAX_LOAD)
+        {
+                // Replacing a value takes no slot, so only grow for new keys.
+                data* found = hmap_search(m, key);
+                if (found != NULL)
+                {
+                        memcpy(found, value, m->_val_size);
+                        return;
+                }
+                _hmap_grow(m);
+        }
+
+        size_t slot_size = _hmap_slot_size(m);
+        size_t mask = m->_slots->len - 1;
+        size_t h = m->_hash(key, m->_key_size);
+
+        // The entry being placed. Starts as the new one, and becomes whichever
+        // one it displaces.
+        struct _hmap_slot* entry = (struct _hmap_slot*)m->_tmp;
+        struct _hmap_slot* swap = (struct _hmap_slot*)(m->_tmp + slot_size);
+        entry->dist = 1;
+        entry->tag = h >> 32;
+        memcpy(entry + 1, key, m->_key_size);
+        memcpy((byte*)entry + m->_val_offset, value, m->_val_size);
+
+        bool displaced = false;
+        for (size_t i = h & mask;; i = (i + 1) & mask, ++entry->dist)
+        {
+                struct _hmap_slot* s = _hmap_at(m, i);
+                if (s->dist == 0)
+                {
+                        memcpy(s, entry, slot_size);
+                        ++m->_n;
+                        return;
+                }
+
+                // Once an entry was displaced, the key can't be further on:
+                // a search would have stopped here.
+                if (!displaced && s->dist == entry->dist
+                    && s->tag == entry->tag && _hmap_eq(m, key, s))
+                {
+                        memcpy((byte*)s + m->_val_offset, value, m->_val_size);
+                        return;
+                }
+
+                if (s->dist < entry->dist)
+                {
+                        // Rob the richer entry of its slot.
+                        memcpy(swap, s, slot_size);
+                        memcpy(s, entry, slot_size);
+                        memcpy(entry, swap, slot_size);
+                        displaced = true;
+                }
+        }
+}
+
+/**
+ * @brief Finds a key on the map and returns a handle to its value, if it
+ * exists.
+ *
+ * Returns null if the key is not on the map. The handle is valid until the
+ * map changes.
+ *
+ * @param m Handle to the map.
+ * @param key Handle to the key to search for.
+ */
+data*
+hmap_search(struct hmap* m, data* key)
+{
+        size_t mask = m->_slots->len - 1;
+        size_t h = m->_hash(key, m->_key_size);
+        uint32_t tag = h >> 32;
+
+        // Entries are ordered by their distance, so the key is not on the map
+        // once an entry closer to its own slot shows up.
+        for (size_t i = h & mask, dist = 1;; i = (i + 1) & mask, ++dist)
+        {
+                struct _hmap_slot* s = _hmap_at(m, i);
+                if (s->dist < dist)
+                {
+                        return NULL;
+                }
+                if (s->dist == dist && s->tag == tag && _hmap_eq(m, key, s))
+                {
+                        return (byte*)s + m->_val_offset;
+                }
+        }
+}
+
+/**
+ * @brief Finds and deletes an entry from the map.
+ *
+ * Does not change the map if the key is not on it.
+ *
+ * @param m Handle to the map.
+ * @param key Handle to the key to delete.
+ * @return Whether or not the key was on the map.
+ */
+bool
+hmap_remove(struct hmap* m, data* key)
+{
+        data* value = hmap_search(m, key);
+        if (value == NULL)
+        {
+                return false;
+        }
+
+        size_t slot_size = _hmap_slot_size(m);
+        size_t mask = m->_slots->len - 1;
+        byte* first = m->_slots->data;
+        size_t i = ((byte*)value - m->_val_offset - first) / slot_size;
+
+        // Shift back every entry after it that is not on its own slot, each
+        // getting one step closer.
+        struct _hmap_slot* s = _hmap_at(m, i);
+        struct _hmap_slot* next = _hmap_at(m, (i + 1) & mask);
+        while (next->dist > 1)
+        {
+                memcpy(s, next, slot_size);
+                --s->dist;
+                i = (i + 1) & mask;
+                s = next;
+                next = _hmap_at(m, (i + 1) & mask);
+        }
+        s->dist = 0;
+        --m->_n;
+
+        return true;
+}
+
+static inline size_t
+_hmap_align(size_t size)
+{
+        // Rounds up to the alignment of size_t, so keys and values can be
+        // read in place.
+        return (size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+}
+
+static inline size_t
+_hmap_slot_size(struct hmap* m)
+{
+        return _hmap_align(m->_val_offset + m->_val_size);
+}
+
+static inline struct _hmap_slot*
+_hmap_at(struct hmap* m, size_t idx)
+{
+        return slice_at(m->_slots, idx);
+}
+
+static inline bool
+_hmap_eq(struct hmap* m, data* key, struct _hmap_slot* s)
+{
+        if (m->_cmp != NULL)
+        {
+                return m->_cmp(key, s + 1) == 0;
+        }
+        return memcmp(key, s + 1, m->_key_size) == 0;
+}
+
+static void
+_hmap_grow(struct hmap* m)
+{
+        // Reinserts every entry on twice the slots.
+        struct slice* old = m->_slots;
+        size_t slot_size = _hmap_slot_size(m);
+
+        m->_slots = slice_make(slot_size, 2 * old->len);
+        memset(m->_slots->data, 0, 2 * old->len * slot_size);
+        m->_slots->len = 2 * old->len;
+        m->_n = 0;
+
+        for (size_t i = 0; i < old->len; ++i)
+        {
+                struct _hmap_slot* s = slice_at(old, i);
+                if (s->dist != 0)
+                {
+                        hmap_insert(m, s + 1, (byte*)s + m->_val_offset);
+                }
+        }
+
+        slice_del(old);
+}
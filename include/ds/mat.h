@@ -43,8 +43,41 @@ mat_make(struct mat* p, size_t el_size, size_t ino, size_t jno)
         p->_data = malloc(ino * jno * el_size);
 }
 
+/**
+ * @brief Initializes a matrix whose array is aligned to the given boundary.
+ *
+ * Same as @ref mat_make, but the array starts on a multiple of `align`. Use
+ * 32 or 64 for matrices read with aligned SIMD loads. Rows after the first
+ * are only aligned if the size of a row is a multiple of `align` too.
+ *
+ * Every call to mat_make_aligned **must** have a matching call to
+ * @ref mat_del to release the managed memory.
+ *
+ * @param p Handle to the slice.
+ * @param el_size Size of each element.
+ * @param ino Number of columns.
+ * @param jno Number of rows.
+ * @param align Alignment in bytes, a power of 2 multiple of
+ * `sizeof(void*)`.
+ */
+void
+mat_make_aligned(struct mat* p, size_t el_size, size_t ino, size_t jno,
+                 size_t align)
+{
+        p->_el_size = el_size;
+        p->_ino = ino;
+        p->_jno = jno;
+        void* data;
+        if (posix_memalign(&data, align, ino * jno * el_size) != 0)
+        {
+                data = NULL;
+        }
+        p->_data = data;
+}
+
 /**
  * @brief Deallocates the memory backing a matrix created by @ref mat_make
+ * or @ref mat_make_aligned.
  *
  * @param p Handle to the matrix.
  */
@@ -3,6 +3,9 @@
 #include <leet.h>
 #pragma icanc end
 
+#include <sys/mman.h>
+#include <unistd.h>
+
 /**
  * @file slice.h
  *
@@ -18,6 +21,42 @@
  */
 #define _SLICE_SCALE_FACTOR 2
 
+/**
+ * @brief How many bytes a slice grows by under @ref SLICE_GROW_CHUNK.
+ */
+#define _SLICE_CHUNK_SIZE (64 * 1024)
+
+/**
+ * @brief Size of a huge page. Arrays under @ref SLICE_GROW_HUGEPAGE are
+ * mapped on their own once they are at least this big.
+ */
+#define _SLICE_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+/**
+ * @brief How a slice grows when it runs out of space.
+ * @see slice_set_growth
+ */
+enum slice_growth
+{
+        /// Multiplies the capacity by @ref _SLICE_SCALE_FACTOR. The default.
+        SLICE_GROW_SCALE,
+        /// Grows by half the capacity. Wastes at most a third of the array,
+        /// and lets the allocator reuse the blocks freed by earlier growths.
+        SLICE_GROW_HALF,
+        /// Grows by @ref _SLICE_CHUNK_SIZE bytes. Wastes at most one chunk,
+        /// but appending n elements copies O(n^2) bytes.
+        SLICE_GROW_CHUNK,
+        /// Rounds the capacity up to the next power of 2. Arrays of at least
+        /// @ref _SLICE_HUGEPAGE_SIZE bytes are mapped with `mmap` instead of
+        /// allocated on the heap. They start on a huge page, and the kernel
+        /// is asked to back them with transparent huge pages
+        /// (`MADV_HUGEPAGE`), so large arrays take fewer TLB misses. They are
+        /// copied to a new mapping when they grow, and the old one is
+        /// returned to the system right away. Arrays shrunk below that size
+        /// move back to the heap.
+        SLICE_GROW_HUGEPAGE,
+};
+
 /**
  * @brief Managed array with autoscaling capabilities.
  *        Building block for array-based data structures that **should not** be
@@ -47,10 +86,21 @@ struct _slice
         size_t len; ///< See @ref slice.
 
         /// @privatesection
-        size_t capacity; ///< Allocated size in bytes.
-        size_t el_size;  ///< Size of each element in bytes.
+        size_t capacity;          ///< Allocated size in bytes.
+        size_t el_size;           ///< Size of each element in bytes.
+        size_t align;             ///< Alignment of the array, or 0 for
+                                  ///< whatever malloc gives.
+        enum slice_growth growth; ///< How the slice grows.
+        bool owned;  ///< Whether the array is a block of its own, that can be
+                     ///< reallocated and freed.
+        bool mapped; ///< Whether the array was mapped with `mmap`, instead of
+                     ///< allocated on the heap.
 };
 
+static size_t _slice_grown(struct _slice* h, size_t el_no);
+static void _slice_realloc(struct _slice* h, size_t capacity);
+static byte* _slice_alloc(size_t align, size_t capacity);
+
 /**
  * @brief Initializes a slice and allocates its memory.
  *
@@ -69,20 +119,139 @@ slice_make(size_t el_size, size_t el_no)
         h->capacity = el_no * el_size;
         h->data = malloc(h->capacity);
         h->len = 0;
+        h->align = 0;
+        h->growth = SLICE_GROW_SCALE;
+        h->owned = true;
+        h->mapped = false;
 
         return (struct slice*)h;
 }
 
 /**
- * @brief Deallocates the memory managed by a slice created by @ref slice_make
+ * @brief Initializes a slice whose array is aligned to the given boundary.
+ *
+ * Same as @ref slice_make, but the array starts on a multiple of `align`,
+ * and keeps doing so as the slice grows. Use 32 or 64 for arrays read with
+ * aligned SIMD loads, or to start them on a cache line.
+ *
+ * Every call to slice_make_aligned **must** have a matching call to
+ * @ref slice_del to release the managed memory.
+ *
+ * @param el_size Size of each element.
+ * @param el_no Number of elements for the initial allocation.
+ * @param align Alignment in bytes, a power of 2 multiple of
+ * `sizeof(void*)`.
+ * @return Handle to the slice.
+ */
+struct slice*
+slice_make_aligned(size_t el_size, size_t el_no, size_t align)
+{
+        struct _slice* h = malloc(sizeof(struct _slice));
+        h->el_size = el_size;
+        h->capacity = el_no * el_size;
+        h->data = _slice_alloc(align, h->capacity);
+        h->len = 0;
+        h->align = align;
+        h->growth = SLICE_GROW_SCALE;
+        h->owned = true;
+        h->mapped = false;
+
+        return (struct slice*)h;
+}
+
+/**
+ * @brief Initializes a slice on memory provided by the caller.
+ *
+ * The slice is placed at the start of `mem` and uses the rest of it as its
+ * array, so it takes no allocations until it outgrows `mem`. It then moves its
+ * elements to the heap and keeps growing there, leaving `mem` alone. Meant for
+ * short-lived slices on the stack or on an arena.
+ *
+ * `mem` **must** be aligned like a pointer, be at least
+ * `sizeof(struct _slice)` bytes long and outlive the slice. Every call to
+ * slice_make_in **must** have a matching call to @ref slice_release, and
+ * **never** one to @ref slice_del.
+ *
+ * ```c
+ * size_t mem[64];
+ * struct slice* s = slice_make_in(mem, sizeof(mem), sizeof(int));
+ * ```
+ *
+ * @param mem Memory for the slice and its first elements.
+ * @param size Size of `mem` in bytes.
+ * @param el_size Size of each element.
+ * @return Handle to the slice.
+ */
+struct slice*
+slice_make_in(data* mem, size_t size, size_t el_size)
+{
+        struct _slice* h = mem;
+        h->el_size = el_size;
+        h->capacity = (size - sizeof(struct _slice)) / el_size * el_size;
+        h->data = (byte*)(h + 1);
+        h->len = 0;
+        h->align = 0;
+        h->growth = SLICE_GROW_SCALE;
+        h->owned = false;
+        h->mapped = false;
+
+        return (struct slice*)h;
+}
+
+/**
+ * @brief Initializes a slice with room for its first elements inline.
  *
+ * Same as @ref slice_make, but the handle and the first `el_no` elements
+ * share a single allocation. The elements move to an array of their own if
+ * the slice outgrows them.
+ *
+ * Every call to slice_make_inline **must** have a matching call to
+ * @ref slice_del to release the managed memory.
+ *
+ * @param el_size Size of each element.
+ * @param el_no Number of elements stored inline.
+ * @return Handle to the slice.
+ */
+struct slice*
+slice_make_inline(size_t el_size, size_t el_no)
+{
+        size_t size = sizeof(struct _slice) + el_no * el_size;
+        return slice_make_in(malloc(size), size, el_size);
+}
+
+/**
+ * @brief Deallocates the array of a slice, but not the slice itself.
+ *
+ * Releases a slice created by @ref slice_make_in. Does nothing unless the
+ * slice outgrew the memory it was given.
+ *
+ * @param p Handle to the slice.
+ */
+void
+slice_release(struct slice* p)
+{
+        struct _slice* h = (struct _slice*)p;
+
+        if (h->mapped)
+        {
+                munmap(h->data, h->capacity);
+        }
+        else if (h->owned)
+        {
+                free(h->data);
+        }
+}
+
+/**
+ * @brief Deallocates the memory managed by a slice created by @ref slice_make
+ * or @ref slice_make_inline.
  *
  * @param p Handle to the slice.
  */
 void
 slice_del(struct slice* p)
 {
-        free(p->data);
+        slice_release(p);
         free(p);
 }
 
@@ -177,7 +346,25 @@ slice_rwd(struct slice* p, size_t rwd)
 }
 
 /**
- * @brief Grows the underlying array by @ref _SLICE_SCALE_FACTOR.
+ * @brief Sets how the slice grows when it runs out of space.
+ *
+ * Only affects later growths, the array is not reallocated.
+ *
+ * @param p Handle to the slice.
+ * @param growth Growth policy.
+ */
+void
+slice_set_growth(struct slice* p, enum slice_growth growth)
+{
+        ((struct _slice*)p)->growth = growth;
+}
+
+/**
+ * @brief Grows the underlying array according to the growth policy of the
+ * slice.
+ *
+ * Always makes room for at least one more element.
+ * @see slice_set_growth
  *
  * @param p Handle to the slice.
  */
@@ -186,8 +373,50 @@ slice_resize(struct slice* p)
 {
         struct _slice* h = (struct _slice*)p;
 
-        h->capacity *= _SLICE_SCALE_FACTOR;
-        h->data = realloc(h->data, h->capacity);
+        _slice_realloc(h, _slice_grown(h, h->len + 1));
+}
+
+/**
+ * @brief Grows the underlying array to hold at least the given number of
+ * elements.
+ *
+ * Does nothing if the slice can already hold them. Appending up to `el_no`
+ * elements with @ref slice_sappend will not reallocate the array afterwards.
+ *
+ * @param p Handle to the slice.
+ * @param el_no Number of elements the slice should be able to hold.
+ */
+void
+slice_reserve(struct slice* p, size_t el_no)
+{
+        struct _slice* h = (struct _slice*)p;
+
+        if (el_no * h->el_size > h->capacity)
+        {
+                _slice_realloc(h, el_no * h->el_size);
+        }
+}
+
+/**
+ * @brief Shrinks the underlying array to the elements on the slice.
+ *
+ * Slices never shrink on their own, so one that held many elements keeps
+ * their memory after @ref slice_clear or @ref slice_rwd until this is called.
+ * Room for one element is kept, so the slice can still grow.
+ *
+ * @param p Handle to the slice.
+ */
+void
+slice_shrink_to_fit(struct slice* p)
+{
+        struct _slice* h = (struct _slice*)p;
+
+        // Memory the slice was given can't be given back.
+        size_t capacity = max(h->len, 1) * h->el_size;
+        if (h->owned && capacity < h->capacity)
+        {
+                _slice_realloc(h, capacity);
+        }
 }
 
 /**
@@ -255,7 +484,7 @@ slice_insert(struct slice* p, data* el, size_t idx)
         if (idx < h->len)
         {
                 byte* end = slice_at(p, p->len);
-                memcpy(ptr + h->el_size, ptr, end - ptr);
+                memmove(ptr + h->el_size, ptr, end - ptr);
         }
         memcpy(ptr, el, h->el_size);
         ++h->len;
@@ -323,7 +552,7 @@ slice_delete_at(struct slice* p, size_t idx)
 
         byte* ptr = slice_at(p, idx);
         byte* end = slice_at(p, p->len);
-        mempcpy(ptr, ptr + h->el_size, end - ptr);
+        memmove(ptr, ptr + h->el_size, end - ptr - h->el_size);
         --h->len;
 }
 
@@ -347,6 +576,97 @@ slice_delete_at_fast(struct slice* p, size_t idx)
         slice_rwd(p, 1);
 }
 
+/**
+ * @brief Appends several values to the end of the slice *checking its
+ * capacity*.
+ *
+ * Copies the `n` elements stored at `els` to the end of the slice with a
+ * single `memcpy`. If the slice is out of space, grows it once to fit all of
+ * them. `els` **must not** point into the slice.
+ *
+ * @param p Handle to the slice.
+ * @param els Pointer to the elements to append.
+ * @param n Number of elements to append.
+ */
+void
+slice_append_n(struct slice* p, data* els, size_t n)
+{
+        struct _slice* h = (struct _slice*)p;
+
+        if ((h->len + n) * h->el_size > h->capacity)
+        {
+                _slice_realloc(h, _slice_grown(h, h->len + n));
+        }
+        memcpy(h->data + h->len * h->el_size, els, n * h->el_size);
+        h->len += n;
+}
+
+/**
+ * @brief Inserts several values into the given position of the slice
+ * *checking its capacity*.
+ *
+ * Copies the `n` elements stored at `els` into the given position of the
+ * slice, shifting existing elements to the right with a single `memmove`. If
+ * the slice is out of space, grows it once to fit all of them. `els` **must
+ * not** point into the slice.
+ *
+ * @param p Handle to the slice.
+ * @param els Pointer to the elements to insert.
+ * @param n Number of elements to insert.
+ * @param idx Index to insert the first element at.
+ */
+void
+slice_insert_n(struct slice* p, data* els, size_t n, size_t idx)
+{
+        struct _slice* h = (struct _slice*)p;
+
+        if ((h->len + n) * h->el_size > h->capacity)
+        {
+                _slice_realloc(h, _slice_grown(h, h->len + n));
+        }
+
+        byte* ptr = slice_at(p, idx);
+        memmove(ptr + n * h->el_size, ptr, (h->len - idx) * h->el_size);
+        memcpy(ptr, els, n * h->el_size);
+        h->len += n;
+}
+
+/**
+ * @brief Appends every element of a slice to the end of another.
+ *
+ * Same as @ref slice_append_n with the elements of `src`. Both slices **must**
+ * have the same element size, and **must not** be the same slice.
+ *
+ * @param dst Handle to the slice to append to.
+ * @param src Handle to the slice to append from.
+ */
+void
+slice_extend(struct slice* dst, struct slice* src)
+{
+        slice_append_n(dst, src->data, src->len);
+}
+
+/**
+ * @brief Deletes several consecutive elements.
+ *
+ * Shifts the elements after them to the left with a single `memmove`. *Does
+ * not* check the bounds, the `n` elements starting at `idx` **must** be on
+ * the slice.
+ *
+ * @param p Handle to the slice.
+ * @param idx Index of the first element to delete.
+ * @param n Number of elements to delete.
+ */
+void
+slice_delete_range(struct slice* p, size_t idx, size_t n)
+{
+        struct _slice* h = (struct _slice*)p;
+
+        byte* ptr = slice_at(p, idx);
+        memmove(ptr, ptr + n * h->el_size, (h->len - idx - n) * h->el_size);
+        h->len -= n;
+}
+
 /**
  * @brief Sets the length to zero, clearing the slice.
  *
@@ -376,3 +696,116 @@ slice_clear(struct slice* p)
              iterator                                                         \
              < (p)->data + (p)->len * ((struct _slice*)(p))->el_size;         \
              iterator = (byte*)iterator + ((struct _slice*)(p))->el_size)
+
+static size_t
+_slice_grown(struct _slice* h, size_t el_no)
+{
+        // Capacity after growing by the policy of the slice, or enough for
+        // el_no elements if that is more.
+        size_t capacity;
+        switch (h->growth)
+        {
+        case SLICE_GROW_HALF:
+                capacity = h->capacity + h->capacity / 2;
+                break;
+        case SLICE_GROW_CHUNK:
+                capacity = h->capacity + _SLICE_CHUNK_SIZE;
+                break;
+        case SLICE_GROW_HUGEPAGE:
+                capacity = 1;
+                while (capacity <= h->capacity)
+                {
+                        capacity *= 2;
+                }
+                break;
+        default:
+                capacity = h->capacity * _SLICE_SCALE_FACTOR;
+                break;
+        }
+
+        return max(capacity, el_no * h->el_size);
+}
+
+static byte*
+_slice_alloc(size_t align, size_t capacity)
+{
+        void* data;
+        if (align == 0 || posix_memalign(&data, align, capacity) != 0)
+        {
+                return malloc(capacity);
+        }
+        return data;
+}
+
+static byte*
+_slice_map(size_t capacity)
+{
+        // Maps a huge page more than needed and trims the excess, so the
+        // array starts on a huge page.
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t len = (capacity + page - 1) / page * page;
+        byte* map = mmap(NULL, len + _SLICE_HUGEPAGE_SIZE,
+                         PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                         -1, 0);
+        if (map == MAP_FAILED)
+        {
+                return NULL;
+        }
+
+        byte* data = (byte*)(((size_t)map + _SLICE_HUGEPAGE_SIZE - 1)
+                             & ~((size_t)_SLICE_HUGEPAGE_SIZE - 1));
+        if (data > map)
+        {
+                munmap(map, data - map);
+        }
+        munmap(data + len, map + _SLICE_HUGEPAGE_SIZE - data);
+
+#ifdef MADV_HUGEPAGE
+        madvise(data, len, MADV_HUGEPAGE);
+#endif
+        return data;
+}
+
+static void
+_slice_move(struct _slice* h, byte* data, size_t capacity)
+{
+        memcpy(data, h->data, h->len * h->el_size);
+        slice_release((struct slice*)h);
+        h->data = data;
+        h->capacity = capacity;
+        h->owned = true;
+        h->mapped = false;
+}
+
+static void
+_slice_realloc(struct _slice* h, size_t capacity)
+{
+        // Huge arrays under SLICE_GROW_HUGEPAGE get a mapping of their own,
+        // and keep one while they are huge, whatever the policy. Smaller
+        // ones, including mapped arrays being shrunk, go to the heap, as do
+        // arrays that fail to map.
+        if ((h->mapped || h->growth == SLICE_GROW_HUGEPAGE)
+            && capacity >= _SLICE_HUGEPAGE_SIZE)
+        {
+                byte* data = _slice_map(capacity);
+                if (data != NULL)
+                {
+                        _slice_move(h, data, capacity);
+                        h->mapped = true;
+                        return;
+                }
+        }
+
+        // realloc can't move an array the slice does not own, or one that
+        // is mapped, and only keeps the alignment of malloc.
+        if (h->owned && !h->mapped)
+        {
+                h->data = realloc(h->data, capacity);
+                h->capacity = capacity;
+                if (h->align == 0 || (size_t)h->data % h->align == 0)
+                {
+                        return;
+                }
+        }
+        _slice_move(h, _slice_alloc(h->align, capacity), capacity);
+}
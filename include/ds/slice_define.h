@@ -0,0 +1,129 @@
+#pragma once
+#pragma icanc include
+#include <leet.h>
+#include <ds/slice.h>
+#pragma icanc end
+
+/**
+ * @file slice_define.h
+ *
+ * `#include <ds/slice_define.h>`
+ *
+ * Typed slices. Every access to a @ref slice goes through the size of its
+ * elements, known only at runtime, and copies them with `memcpy` of that
+ * size, which keeps the compiler from turning a loop over a slice into plain
+ * loads and stores, let alone vectorizing it. @ref SLICE_DEFINE generates a
+ * slice for one element type instead: elements are read and written through
+ * a `T*`, copied by assignment and indexed with a size known at compile
+ * time.
+ *
+ * A typed slice has the same layout as a @ref slice, so the two **may** be
+ * converted into each other and every `slice_*` function works on either.
+ * For a slice named `name` of elements of type `T`, the generated API is:
+ *
+ * - `struct name* name_make(size_t el_no)`
+ * - `void name_del(struct name* p)`
+ * - `struct name* name_of(struct slice* p)`
+ * - `struct slice* name_slice(struct name* p)`
+ * - `T* name_at(struct name* p, size_t idx)`
+ * - `void name_push(struct name* p, T el)`
+ * - `void name_insert(struct name* p, T el, size_t idx)`
+ *
+ * `name_push` and `name_insert` grow the slice like @ref slice_sappend and
+ * @ref slice_sinsert. Every generated function is `static inline`, so a slice
+ * **may** be defined in as many translation units as needed.
+ *
+ * ```c
+ * SLICE_DEFINE(ints, int)
+ *
+ * struct ints* s = ints_make(16);
+ * ints_push(s, 42);
+ * int sum = 0;
+ * for (size_t i = 0; i < s->len; ++i)
+ *         sum += *ints_at(s, i);
+ * ints_del(s);
+ * ```
+ */
+
+/**
+ * @brief Defines a typed slice.
+ *
+ * @param name Name of the slice struct, also used as the prefix for every
+ * generated function.
+ * @param T Type of the elements.
+ */
+#define SLICE_DEFINE(name, T)                                                 \
+        /* Accessed through both types, tell the compiler they alias. */      \
+        struct __attribute__((__may_alias__)) name                            \
+        {                                                                     \
+                T* data;                                                      \
+                size_t len;                                                   \
+                                                                              \
+                size_t capacity;                                              \
+                size_t el_size;                                               \
+                size_t align;                                                 \
+                enum slice_growth growth;                                     \
+                bool owned;                                                   \
+                bool mapped;                                                  \
+        };                                                                    \
+        /* The fields above copy struct _slice, which must not drift. */      \
+        _Static_assert(sizeof(struct name) == sizeof(struct _slice)           \
+                           && offsetof(struct name, el_size)                  \
+                                  == offsetof(struct _slice, el_size)         \
+                           && offsetof(struct name, mapped)                   \
+                                  == offsetof(struct _slice, mapped),         \
+                       #name " does not match the layout of struct _slice");  \
+                                                                              \
+        static inline struct name*                                            \
+        name##_of(struct slice* p)                                            \
+        {                                                                     \
+                return (struct name*)p;                                       \
+        }                                                                     \
+                                                                              \
+        static inline struct slice*                                           \
+        name##_slice(struct name* p)                                          \
+        {                                                                     \
+                return (struct slice*)p;                                      \
+        }                                                                     \
+                                                                              \
+        static inline struct name*                                            \
+        name##_make(size_t el_no)                                             \
+        {                                                                     \
+                return name##_of(slice_make(sizeof(T), el_no));               \
+        }                                                                     \
+                                                                              \
+        static inline void                                                    \
+        name##_del(struct name* p)                                            \
+        {                                                                     \
+                slice_del(name##_slice(p));                                   \
+        }                                                                     \
+                                                                              \
+        static inline T*                                                      \
+        name##_at(struct name* p, size_t idx)                                 \
+        {                                                                     \
+                return p->data + idx;                                         \
+        }                                                                     \
+                                                                              \
+        static inline void                                                    \
+        name##_push(struct name* p, T el)                                     \
+        {                                                                     \
+                /* Growing is rare, the generic path is fine for it. */       \
+                if (p->len * sizeof(T) >= p->capacity)                        \
+                {                                                             \
+                        slice_resize(name##_slice(p));                        \
+                }                                                             \
+                p->data[p->len++] = el;                                       \
+        }                                                                     \
+                                                                              \
+        static inline void                                                    \
+        name##_insert(struct name* p, T el, size_t idx)                       \
+        {                                                                     \
+                if (p->len * sizeof(T) >= p->capacity)                        \
+                {                                                             \
+                        slice_resize(name##_slice(p));                        \
+                }                                                             \
+                memmove(p->data + idx + 1, p->data + idx,                     \
+                        (p->len - idx) * sizeof(T));                          \
+                p->data[idx] = el;                                            \
+                ++p->len;                                                     \
+        }
@@ -7,8 +7,11 @@ main()
 {
         unsigned int no;
         char buf[1001];
+        // Room for the stack and the 1000 pushes a line can make, so it never
+        // touches the heap.
+        size_t mem[160];
 
-        struct slice* s = arrstack_make(sizeof(char), 1000);
+        struct slice* s = arrstack_make_in(mem, sizeof(mem), sizeof(char));
 
         scanf("%u\n", &no);
         do
@@ -30,6 +33,6 @@ main()
                 arrstack_clear(s);
         } while (--no);
 
-        arrstack_del(s);
+        arrstack_release(s);
         return 0;
 }
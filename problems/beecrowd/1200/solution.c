@@ -23,6 +23,14 @@ finder(void* val, void* n)
         return *(char*)val - container_of(n, struct holder, bst)->data;
 }
 
+void
+append_node(struct bstree* root, struct slice* out)
+{
+        // The value and its separator in one go.
+        char node[] = { container_of(root, struct holder, bst)->data, ' ' };
+        slice_append_n(out, node, sizeof(node));
+}
+
 void
 infix(struct bstree* root, struct slice* out)
 {
@@ -30,8 +38,7 @@ infix(struct bstree* root, struct slice* out)
                 return;
 
         infix(root->_left, out);
-        slice_append(out, &container_of(root, struct holder, bst)->data);
-        slice_append(out, &" ");
+        append_node(root, out);
         infix(root->_right, out);
 }
 
@@ -41,8 +48,7 @@ prefix(struct bstree* root, struct slice* out)
         if (!root)
                 return;
 
-        slice_append(out, &container_of(root, struct holder, bst)->data);
-        slice_append(out, &" ");
+        append_node(root, out);
         prefix(root->_left, out);
         prefix(root->_right, out);
 }
@@ -55,8 +61,7 @@ postfix(struct bstree* root, struct slice* out)
 
         postfix(root->_left, out);
         postfix(root->_right, out);
-        slice_append(out, &container_of(root, struct holder, bst)->data);
-        slice_append(out, &" ");
+        append_node(root, out);
 }
 
 void
@@ -1,25 +1,39 @@
+import argparse
 import json
 import sys
 from os import path
 
-# Transforms a benchmark result into a box chart json.
+# Transforms benchmark results into a box chart json.
+# Samples are recorded in nanoseconds and plotted in milliseconds.
 # Used to add benchmark charts to docs.
 #
 # Args:
-# <benchmark csv (input)>
 # <chart json (output)>
-# <benchmark runs to include on the chart>
+# --runs <benchmark runs to include on the chart>
+# --csv <benchmark csvs (input), one per optimization profile>
+# --metric <column to plot, ns by default or one of the hardware counters>
+#
+# Benchmark csvs are named <benchmark>.<profile>.csv, each profile becomes its
+# own series on the chart. Benchmarks that ran with BENCHMARK_COUNTERS start
+# with a "benchmark,ns,<counter>,..." header naming the extra columns.
+
+parser = argparse.ArgumentParser()
+parser.add_argument("dst")
+parser.add_argument("--runs", nargs="+", required=True)
+parser.add_argument("--csv", nargs="+", required=True)
+parser.add_argument("--metric", default="ns")
+args = parser.parse_args()
 
-src = sys.argv[1]
-dst = sys.argv[2]
-runs = sys.argv[3:]
+colors = ["#2980b9", "#27ae60", "#d35400", "#8e44ad", "#c0392b"]
 
 chart = {
     "data": [],
     "layout": {
         "showlegend": False,
         "xaxis": {
-            "title": { "text": "Time (ms)" },
+            "title": {
+                "text": "Time (ms)" if args.metric == "ns" else args.metric
+            },
             "type": "linear"
         },
         "yaxis": { "type": "category" },
@@ -27,18 +41,33 @@ chart = {
     }
 }
 
-with open(src) as csv_in:
-    for run in csv_in.readlines():
-        [name, times] = run.rstrip().split(",")
-        if name in runs:
+for i, src in enumerate(args.csv):
+    profile = path.basename(src).split(".")[-2]
+    color = colors[i % len(colors)]
+
+    with open(src) as csv_in:
+        columns = ["benchmark", "ns"]
+        for run in csv_in.readlines():
+            fields = run.rstrip().split(",")
+            if fields[0] == "benchmark":
+                columns = fields
+                continue
+            if fields[0] not in args.runs:
+                continue
+            if args.metric not in columns:
+                sys.exit(f"{src} has no {args.metric} column")
+
+            name = fields[0]
+            samples = fields[columns.index(args.metric)].split(";")
+            scale = 1e6 if args.metric == "ns" else 1
             chart["data"].append({
-                "x": list(map(int, times.split(";"))),
-                "line": { "color": "#2980b9" },
+                "x": [int(s) / scale for s in samples],
+                "line": { "color": color },
                 "type": "box",
-                "name": name,
+                "name": f"{name} ({profile})",
                 "orientation": "h",
                 "width": 0.15
             })
 
-with open(dst, "w", encoding="utf-8") as json_out:
+with open(args.dst, "w", encoding="utf-8") as json_out:
     json.dump(chart, json_out)
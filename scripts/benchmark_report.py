@@ -0,0 +1,146 @@
+import argparse
+import random
+import shutil
+import sys
+from os import path
+
+# Summarizes benchmark results and checks them against a stored baseline.
+# Exits with a non-zero status if any run regressed beyond the threshold.
+#
+# Args:
+# <benchmark csvs (input)>
+# --baseline <directory holding baseline csvs with the same file names>
+# --threshold <allowed slowdown of the median, in percent>
+# --metric <column to compare, ns by default or one of the hardware counters>
+# --update <copy the inputs over the baseline instead of comparing>
+#
+# A run regresses when its median is more than threshold percent above the
+# baseline median *and* the bootstrap confidence intervals of both medians do
+# not overlap, so a noisy run does not fail the check on its own.
+
+BOOTSTRAP_RESAMPLES = 2000
+CONFIDENCE = 0.95
+
+parser = argparse.ArgumentParser()
+parser.add_argument("csv", nargs="+")
+parser.add_argument("--baseline")
+parser.add_argument("--threshold", type=float, default=5)
+parser.add_argument("--metric", default="ns")
+parser.add_argument("--update", action="store_true")
+args = parser.parse_args()
+
+
+def read_runs(src):
+    runs = {}
+    columns = ["benchmark", "ns"]
+    with open(src) as csv_in:
+        for run in csv_in.readlines():
+            fields = run.rstrip().split(",")
+            if fields[0] == "benchmark":
+                columns = fields
+                continue
+            if args.metric not in columns:
+                sys.exit(f"{src} has no {args.metric} column")
+
+            samples = fields[columns.index(args.metric)].split(";")
+            runs[fields[0]] = sorted(int(s) for s in samples)
+    return runs
+
+
+def percentile(samples, p):
+    # Linear interpolation between the closest ranks, samples must be sorted.
+    k = (len(samples) - 1) * p
+    lo = int(k)
+    hi = min(lo + 1, len(samples) - 1)
+    return samples[lo] + (samples[hi] - samples[lo]) * (k - lo)
+
+
+def median(samples):
+    return percentile(samples, 0.5)
+
+
+def mad(samples):
+    m = median(samples)
+    return median(sorted(abs(s - m) for s in samples))
+
+
+def bootstrap(samples):
+    # Confidence interval of the median. Seeded so reruns over the same data
+    # give the same report.
+    rng = random.Random(0)
+    medians = sorted(
+        median(sorted(rng.choices(samples, k=len(samples))))
+        for _ in range(BOOTSTRAP_RESAMPLES)
+    )
+    alpha = (1 - CONFIDENCE) / 2
+    return (percentile(medians, alpha), percentile(medians, 1 - alpha))
+
+
+def summarize(samples):
+    return {
+        "median": median(samples),
+        "p90": percentile(samples, 0.9),
+        "p99": percentile(samples, 0.99),
+        "mad": mad(samples),
+        "ci": bootstrap(samples),
+    }
+
+
+def fmt(value):
+    if args.metric == "ns":
+        return f"{value / 1e6:.3f}ms"
+    return f"{value:.0f}"
+
+
+if args.update:
+    if not args.baseline:
+        sys.exit("--update needs a --baseline directory")
+    for src in args.csv:
+        shutil.copy(src, path.join(args.baseline, path.basename(src)))
+        print(f"updated baseline {path.basename(src)}")
+    sys.exit(0)
+
+regressions = []
+print(
+    f"{'run':<32} {'median':>12} {'p90':>12} {'p99':>12} {'mad':>12}"
+    f" {'ci':>27} {'change':>9}"
+)
+for src in args.csv:
+    benchmark = path.basename(src).removesuffix(".csv")
+
+    baseline = {}
+    if args.baseline:
+        baseline_csv = path.join(args.baseline, path.basename(src))
+        if path.exists(baseline_csv):
+            baseline = read_runs(baseline_csv)
+
+    for name, samples in read_runs(src).items():
+        stats = summarize(samples)
+        ci = f"[{fmt(stats['ci'][0])}, {fmt(stats['ci'][1])}]"
+
+        change = ""
+        if name in baseline:
+            base = summarize(baseline[name])
+            if base["median"] == 0:
+                # Counters such as misses may be 0, any increase from it is a
+                # change, just not one with a percentage.
+                delta = float("inf") if stats["median"] > 0 else 0.0
+                change = "n/a"
+            else:
+                delta = (stats["median"] / base["median"] - 1) * 100
+                change = f"{delta:+.1f}%"
+            if delta > args.threshold and stats["ci"][0] > base["ci"][1]:
+                regressions.append(f"{benchmark} {name}")
+                change += " !"
+
+        print(
+            f"{benchmark + ' ' + name:<32} {fmt(stats['median']):>12}"
+            f" {fmt(stats['p90']):>12} {fmt(stats['p99']):>12}"
+            f" {fmt(stats['mad']):>12} {ci:>27} {change:>9}"
+        )
+
+if regressions:
+    print(f"\nregressed by more than {args.threshold}%:")
+    for regression in regressions:
+        print(f"  {regression}")
+    sys.exit(1)
@@ -0,0 +1,115 @@
+#include "../tests.h"
+
+#include <alg/search.h>
+
+int
+main()
+{
+        start();
+
+        test(linear);
+        test(binary);
+        test(i32);
+        test(i64);
+        test(lower_bound);
+
+        end();
+}
+
+// Sorted, with duplicates and gaps: every key in [-1, 2 * n] is searched.
+#define make_arr(type, a, n)                                                  \
+        type a[n];                                                            \
+        for (int _i = 0; _i < (n); ++_i)                                      \
+                a[_i] = _i - _i % 3;
+
+size_t
+expected(int64_t* a, size_t n, int64_t key)
+{
+        size_t i = 0;
+        while (i < n && a[i] < key)
+                ++i;
+        return i;
+}
+
+int
+linear()
+{
+        for (size_t n = 0; n < 40; ++n)
+        {
+                make_arr(int64_t, a, 40);
+                for (int64_t key = -1; key <= 2 * (int64_t)n; ++key)
+                {
+                        should(eq(search_linear(a, n, sizeof(int64_t), &key,
+                                                search_cmp_i64),
+                                  expected(a, n, key)),
+                               "linear search missed the lower bound");
+                }
+        }
+
+        return 0;
+}
+
+int
+binary()
+{
+        for (size_t n = 0; n < 40; ++n)
+        {
+                make_arr(int64_t, a, 40);
+                for (int64_t key = -1; key <= 2 * (int64_t)n; ++key)
+                {
+                        should(eq(search_binary(a, n, sizeof(int64_t), &key,
+                                                search_cmp_i64),
+                                  expected(a, n, key)),
+                               "binary search missed the lower bound");
+                }
+        }
+
+        return 0;
+}
+
+int
+i32()
+{
+        for (size_t n = 0; n < 40; ++n)
+        {
+                make_arr(int32_t, a, 40);
+                make_arr(int64_t, b, 40);
+                for (int32_t key = -1; key <= 2 * (int32_t)n; ++key)
+                {
+                        should(eq(search_i32(a, n, key), expected(b, n, key)),
+                               "i32 search missed the lower bound");
+                }
+        }
+
+        return 0;
+}
+
+int
+i64()
+{
+        for (size_t n = 0; n < 40; ++n)
+        {
+                make_arr(int64_t, a, 40);
+                for (int64_t key = -1; key <= 2 * (int64_t)n; ++key)
+                {
+                        should(eq(search_i64(a, n, key), expected(a, n, key)),
+                               "i64 search missed the lower bound");
+                }
+        }
+
+        return 0;
+}
+
+int
+lower_bound()
+{
+        make_arr(int32_t, a, 20);
+        int32_t key = 7;
+
+        should(eq(search_lower_bound(a, 20, sizeof(int32_t), &key,
+                                     search_cmp_i32),
+                  search_binary(a, 20, sizeof(int32_t), &key, search_cmp_i32)),
+               "dispatched search did not match binary search");
+
+        return 0;
+}
@@ -10,6 +10,7 @@ main()
         test(peek);
         test(pop);
         test(rwd);
+        test(make_in);
 
         end();
 }
@@ -71,3 +72,23 @@ rwd()
         arrstack_del(s);
         return 0;
 }
+
+int
+make_in()
+{
+        size_t mem[8];
+        struct slice* s = arrstack_make_in(mem, sizeof(mem), sizeof(int));
+        int dst;
+
+        for (int i = 0; i < 100; ++i)
+                arrstack_spush(s, &i);
+        for (int i = 99; i >= 0; --i)
+        {
+                arrstack_pop(s, &dst);
+                should(eq(dst, i), "stack did not survive spilling");
+        }
+        should(arrstack_empty(s), "stack was not emptied");
+
+        arrstack_release(s);
+        return 0;
+}
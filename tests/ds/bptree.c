@@ -0,0 +1,290 @@
+#include "../tests.h"
+
+#include <ds/bptree.h>
+
+int
+main()
+{
+        start();
+
+        test(create);
+        test(insert_delete_random);
+        test(search);
+        test(search_mixed_sizes);
+        test(replace);
+        test(small_nodes);
+        test(scan);
+        test(range);
+
+        end();
+}
+
+int
+create()
+{
+        struct bptree* tree = bptree_create(sizeof(char), sizeof(int));
+
+        should(eq((size_t)tree % _BPTREE_CACHE_LINE, 0),
+               "node was not aligned to a cache line");
+        should(tree->_leaf_max >= 3 && tree->_inner_max >= 3,
+               "nodes held less than 3 keys");
+
+        bptree_destroy(tree);
+
+        return 0;
+}
+
+int
+cmp_int(void* a, void* b)
+{
+        return *(int*)a - *(int*)b;
+}
+
+int vals[]
+    = { 44, 19, 13, 39, 94, 7,  36, 75, 77, 24, 52, 49, 28, 79, 88, 26, 59,
+        12, 35, 33, 67, 78, 96, 71, 14, 41, 5,  53, 83, 66, 34, 60, 45, 40,
+        98, 92, 27, 99, 69, 65, 74, 54, 1,  89, 61, 76, 57, 84, 80, 97, 46,
+        64, 32, 29, 81, 87, 68, 42, 91, 93, 9,  2,  23, 37, 48, 58, 50, 73,
+        43, 86, 72, 18, 56, 0,  38, 70, 85, 22, 63, 82, 47, 30, 55, 62, 90,
+        16, 3,  31, 25, 21, 20, 17, 8,  51, 95, 15, 10, 4,  6,  11 };
+int valno = sizeof(vals) / sizeof(int);
+
+int
+insert_delete_random()
+{
+        struct bptree* tree = bptree_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; ++i)
+        {
+                bptree_insert(&tree, &i, &i, cmp_int);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                should(bptree_remove(&tree, vals + i, cmp_int),
+                       "inserted key was not removed");
+        }
+        should(tree->_leaf && eq(tree->_n, 0), "tree was not empty");
+
+        bptree_destroy(tree);
+
+        return 0;
+}
+
+int
+search()
+{
+        struct bptree* tree = bptree_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; ++i)
+        {
+                bptree_insert(&tree, vals + i, vals + i, cmp_int);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int* val = bptree_search(tree, &i, cmp_int);
+                should(val != NULL, "inserted key was not found");
+                should(eq(*val, i), "value did not match key");
+        }
+
+        for (int i = 0; i < valno; i += 2)
+        {
+                should(bptree_remove(&tree, &i, cmp_int),
+                       "inserted key was not removed");
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int* val = bptree_search(tree, &i, cmp_int);
+                should(eq(val != NULL, i % 2), "removed key was found");
+        }
+
+        bptree_destroy(tree);
+
+        return 0;
+}
+
+int
+cmp_char(void* a, void* b)
+{
+        return *(char*)a - *(char*)b;
+}
+
+int
+search_mixed_sizes()
+{
+        // Keys smaller than the values, so the values need padding to be
+        // aligned.
+        struct bptree* tree = bptree_create(sizeof(char), sizeof(long));
+
+        should(_bptree_values(tree) + tree->_leaf_max * sizeof(long)
+                   <= _BPTREE_LINES * _BPTREE_CACHE_LINE,
+               "padded leaf did not fit in its cache lines");
+
+        for (int i = 0; i < valno; ++i)
+        {
+                char key = vals[i];
+                long value = -(long)vals[i];
+                bptree_insert(&tree, &key, &value, cmp_char);
+        }
+        should(!tree->_leaf, "root was not split");
+
+        for (int i = 0; i < valno; ++i)
+        {
+                char key = i;
+                long* val = bptree_search(tree, &key, cmp_char);
+                should(val != NULL, "inserted key was not found");
+                should(eq((size_t)val % sizeof(long), 0),
+                       "value was not aligned");
+                should(eq(*val, -(long)i), "value did not match key");
+        }
+
+        bptree_destroy(tree);
+
+        return 0;
+}
+
+int
+replace()
+{
+        struct bptree* tree = bptree_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; ++i)
+        {
+                bptree_insert(&tree, vals + i, vals + i, cmp_int);
+        }
+        for (int i = 0; i < valno; ++i)
+        {
+                int value = -i;
+                bptree_insert(&tree, &i, &value, cmp_int);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int* val = bptree_search(tree, &i, cmp_int);
+                should(eq(*val, -i), "value was not replaced");
+        }
+
+        bptree_destroy(tree);
+
+        return 0;
+}
+
+int
+small_nodes()
+{
+        // One cache line per node splits and merges on almost every
+        // operation.
+        struct bptree* tree = bptree_create_lines(sizeof(int), sizeof(int), 1);
+        bool present[100] = { false };
+
+        srand(0);
+        for (int i = 0; i < 10000; ++i)
+        {
+                int key = rand() % 100;
+                if (rand() % 2)
+                {
+                        bptree_insert(&tree, &key, &key, cmp_int);
+                        present[key] = true;
+                }
+                else
+                {
+                        should(eq(bptree_remove(&tree, &key, cmp_int),
+                                  present[key]),
+                               "remove did not match the inserted keys");
+                        present[key] = false;
+                }
+        }
+
+        for (int i = 0; i < 100; ++i)
+        {
+                int* val = bptree_search(tree, &i, cmp_int);
+                should(eq(val != NULL, present[i]),
+                       "search did not match the inserted keys");
+        }
+
+        bptree_destroy(tree);
+
+        return 0;
+}
+
+int
+scan()
+{
+        struct bptree* tree = bptree_create_lines(sizeof(int), sizeof(int), 1);
+        struct bptree_cursor c;
+
+        should(!bptree_seek(&c, tree, NULL, cmp_int), "empty tree had a key");
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int key = 2 * vals[i];
+                bptree_insert(&tree, &key, vals + i, cmp_int);
+        }
+
+        int i = 0;
+        for (bool ok = bptree_seek(&c, tree, NULL, cmp_int); ok;
+             ok = bptree_next(&c))
+        {
+                should(eq(*(int*)bptree_cursor_key(&c), 2 * i),
+                       "keys were not in order");
+                should(eq(*(int*)bptree_cursor_value(&c), i),
+                       "value did not match key");
+                ++i;
+        }
+        should(eq(i, valno), "not every key was visited");
+
+        // Missing keys seek to the next one.
+        int key = 2 * valno - 3;
+        should(bptree_seek(&c, tree, &key, cmp_int), "seek fell off the tree");
+        should(eq(*(int*)bptree_cursor_key(&c), 2 * valno - 2),
+               "seek did not stop at the next key");
+        should(!bptree_next(&c), "next went past the end");
+
+        key = 2 * valno;
+        should(!bptree_seek(&c, tree, &key, cmp_int),
+               "seek went past the end");
+
+        bptree_destroy(tree);
+
+        return 0;
+}
+
+void
+sum_values(void* key, void* value, void* ctx)
+{
+        *(int*)ctx += *(int*)value;
+}
+
+int
+range()
+{
+        struct bptree* tree = bptree_create_lines(sizeof(int), sizeof(int), 1);
+
+        for (int i = 0; i < valno; ++i)
+        {
+                bptree_insert(&tree, vals + i, vals + i, cmp_int);
+        }
+
+        int sum = 0;
+        int lo = 10;
+        int hi = 19;
+        should(eq(bptree_range(tree, &lo, &hi, cmp_int, sum_values, &sum), 10),
+               "range visited the wrong number of keys");
+        should(eq(sum, 145), "range visited the wrong keys");
+
+        sum = 0;
+        should(eq(bptree_range(tree, &hi, NULL, cmp_int, sum_values, &sum),
+                  valno - 19),
+               "open range visited the wrong number of keys");
+        should(eq(sum, valno * (valno - 1) / 2 - 171),
+               "open range visited the wrong keys");
+
+        should(eq(bptree_range(tree, &hi, &lo, cmp_int, sum_values, &sum), 0),
+               "empty range visited keys");
+
+        bptree_destroy(tree);
+
+        return 0;
+}
@@ -11,6 +11,15 @@ main()
         test(insert_delete);
         test(insert_delete_random);
         test(insert_random_delete);
+        test(search);
+        test(bulk_load);
+        test(cursor);
+        test(range);
+        test(insert_batch);
+        test(search_batch);
+        test(pool);
+        test(snapshot);
+        test(stats);
 
         end();
 }
@@ -101,3 +110,375 @@ insert_random_delete()
 
         return 0;
 }
+
+int
+search()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; ++i)
+        {
+                btree_insert(&tree, vals + i, vals + i, cmp_int);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int* val = btree_search(tree, &i, cmp_int);
+                should(val != NULL, "inserted key was not found");
+                should(eq(*val, i), "value did not match key");
+        }
+
+        for (int i = 0; i < valno; i += 2)
+        {
+                should(btree_remove(&tree, &i, cmp_int),
+                       "inserted key was not removed");
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int* val = btree_search(tree, &i, cmp_int);
+                should(eq(val != NULL, i % 2), "removed key was found");
+        }
+
+        btree_destroy(tree);
+
+        return 0;
+}
+
+int
+bulk_load()
+{
+        int keys[1000];
+        for (int i = 0; i < 1000; ++i)
+        {
+                keys[i] = 2 * i;
+        }
+
+        int sizes[] = { 0, 1, 7, 8, 9, 100, 1000 };
+        double fills[] = { 0, 0.5, 0.7, 1 };
+        for (int s = 0; s < 7; ++s)
+        {
+                for (int f = 0; f < 4; ++f)
+                {
+                        struct btree* tree = btree_bulk_load(
+                            keys, keys, sizes[s], sizeof(int), sizeof(int),
+                            fills[f]);
+
+                        for (int i = 0; i < 2 * sizes[s]; ++i)
+                        {
+                                int* val = btree_search(tree, &i, cmp_int);
+                                should(eq(val != NULL, i % 2 == 0),
+                                       "loaded keys did not match");
+                                should(val == NULL || eq(*val, i),
+                                       "value did not match key");
+                        }
+
+                        // The loaded tree must stay valid after updates.
+                        for (int i = 1; i < 2 * sizes[s]; i += 2)
+                        {
+                                btree_insert(&tree, &i, &i, cmp_int);
+                        }
+                        for (int i = 0; i < 2 * sizes[s]; ++i)
+                        {
+                                should(btree_remove(&tree, &i, cmp_int),
+                                       "key was not removed");
+                        }
+                        should(eq(tree->keys->len, 0), "tree was not empty");
+
+                        btree_destroy(tree);
+                }
+        }
+
+        return 0;
+}
+
+int
+cursor()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        struct btree_cursor c;
+
+        should(!btree_seek(&c, tree, NULL, cmp_int), "empty tree had a key");
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int key = 2 * vals[i];
+                btree_insert(&tree, &key, vals + i, cmp_int);
+        }
+
+        int i = 0;
+        for (bool ok = btree_seek(&c, tree, NULL, cmp_int); ok;
+             ok = btree_next(&c))
+        {
+                should(eq(*(int*)btree_cursor_key(&c), 2 * i),
+                       "keys were not in order");
+                should(eq(*(int*)btree_cursor_value(&c), i),
+                       "value did not match key");
+                ++i;
+        }
+        should(eq(i, valno), "not every key was visited");
+
+        // Missing keys seek to the next one.
+        int key = 2 * valno - 3;
+        should(btree_seek(&c, tree, &key, cmp_int), "seek fell off the tree");
+        for (i = valno - 1; i >= 0; --i)
+        {
+                should(eq(*(int*)btree_cursor_key(&c), 2 * i),
+                       "keys were not in reverse order");
+                should(eq(btree_prev(&c), i > 0), "prev did not stop");
+        }
+
+        key = 2 * valno;
+        should(!btree_seek(&c, tree, &key, cmp_int), "seek went past the end");
+
+        btree_destroy(tree);
+
+        return 0;
+}
+
+void
+sum_values(void* key, void* value, void* ctx)
+{
+        *(int*)ctx += *(int*)value;
+}
+
+int
+range()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; ++i)
+        {
+                btree_insert(&tree, vals + i, vals + i, cmp_int);
+        }
+
+        int sum = 0;
+        int lo = 10;
+        int hi = 19;
+        should(eq(btree_range(tree, &lo, &hi, cmp_int, sum_values, &sum), 10),
+               "range visited the wrong number of keys");
+        should(eq(sum, 145), "range visited the wrong keys");
+
+        sum = 0;
+        should(eq(btree_range(tree, NULL, &lo, cmp_int, sum_values, &sum), 11),
+               "open range visited the wrong number of keys");
+        should(eq(sum, 55), "open range visited the wrong keys");
+
+        should(eq(btree_range(tree, &hi, &lo, cmp_int, sum_values, &sum), 0),
+               "empty range visited keys");
+
+        btree_destroy(tree);
+
+        return 0;
+}
+
+int
+insert_batch()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+
+        // Two batches, the second one interleaved with the first.
+        int evens[50];
+        int odds[50];
+        for (int i = 0; i < valno; ++i)
+        {
+                if (vals[i] % 2)
+                {
+                        odds[vals[i] / 2] = vals[i];
+                }
+                else
+                {
+                        evens[vals[i] / 2] = vals[i];
+                }
+        }
+        btree_insert_batch(&tree, evens, evens, 50, cmp_int);
+        btree_insert_batch(&tree, odds, odds, 50, cmp_int);
+
+        struct btree_cursor c;
+        int i = 0;
+        for (bool ok = btree_seek(&c, tree, NULL, cmp_int); ok;
+             ok = btree_next(&c))
+        {
+                should(eq(*(int*)btree_cursor_key(&c), i),
+                       "keys were not in order");
+                should(eq(*(int*)btree_cursor_value(&c), i),
+                       "value did not match key");
+                ++i;
+        }
+        should(eq(i, valno), "not every key was inserted");
+
+        for (i = 0; i < valno; ++i)
+        {
+                should(btree_remove(&tree, &i, cmp_int),
+                       "inserted key was not removed");
+        }
+
+        btree_destroy(tree);
+
+        return 0;
+}
+
+int
+search_batch()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; i += 2)
+        {
+                btree_insert(&tree, vals + i, vals + i, cmp_int);
+        }
+
+        int* found[100];
+        btree_search_batch(tree, vals, valno, (void**)found, cmp_int);
+
+        for (int i = 0; i < valno; ++i)
+        {
+                should(eq(found[i] != NULL, i % 2 == 0),
+                       "search did not match the inserted keys");
+                should(found[i] == NULL || eq(*found[i], vals[i]),
+                       "value did not match key");
+        }
+
+        btree_destroy(tree);
+
+        return 0;
+}
+
+int
+pool()
+{
+        struct btree_pool* pool = btree_pool_create(sizeof(int), sizeof(int));
+
+        for (int round = 0; round < 2; ++round)
+        {
+                struct btree* tree = btree_create_pooled(pool);
+                for (int i = 0; i < valno; ++i)
+                {
+                        btree_insert(&tree, vals + i, vals + i, cmp_int);
+                }
+                for (int i = 0; i < valno; i += 2)
+                {
+                        should(btree_remove(&tree, &i, cmp_int),
+                               "inserted key was not removed");
+                }
+                for (int i = 0; i < valno; ++i)
+                {
+                        int* val = btree_search(tree, &i, cmp_int);
+                        should(eq(val != NULL, i % 2),
+                               "search did not match the inserted keys");
+                }
+
+                // Release the first tree node by node, the second one all at
+                // once.
+                if (round == 0)
+                {
+                        btree_destroy(tree);
+                }
+                btree_pool_reset(pool);
+        }
+
+        btree_pool_destroy(pool);
+
+        return 0;
+}
+
+int
+snapshot()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        struct btree_cursor c;
+
+        for (int i = 0; i < valno; ++i)
+        {
+                btree_insert(&tree, vals + i, vals + i, cmp_int);
+        }
+        struct btree* snap = btree_snapshot(tree);
+        should(btree_seek(&c, snap, NULL, cmp_int), "snapshot was empty");
+
+        // Change the tree while walking the snapshot.
+        for (int i = 0; i < valno; i += 2)
+        {
+                should(btree_remove(&tree, &i, cmp_int),
+                       "inserted key was not removed");
+        }
+        for (int i = valno; i < 2 * valno; ++i)
+        {
+                btree_insert(&tree, &i, &i, cmp_int);
+        }
+
+        int i = 0;
+        do
+        {
+                should(eq(*(int*)btree_cursor_key(&c), i),
+                       "snapshot changed with the tree");
+                ++i;
+        } while (btree_next(&c));
+        should(eq(i, valno), "snapshot changed with the tree");
+
+        for (int i = 0; i < 2 * valno; ++i)
+        {
+                int* val = btree_search(tree, &i, cmp_int);
+                should(eq(val != NULL, i >= valno || i % 2),
+                       "tree did not change");
+        }
+
+        // Changes to the snapshot don't reach the tree either.
+        int key = 1;
+        btree_remove(&snap, &key, cmp_int);
+        should(btree_search(tree, &key, cmp_int) != NULL,
+               "tree changed with the snapshot");
+
+        btree_destroy(snap);
+        btree_destroy(tree);
+
+        return 0;
+}
+
+int
+stats()
+{
+        // The smallest degree, so a hundred keys make a few levels.
+        struct btree* tree = btree_create_block(sizeof(int), sizeof(int), 0);
+        struct btree_stats s;
+
+        btree_stats(tree, &s);
+        should(eq(s.height, 1) && eq(s.nodes, 1) && eq(s.entries, 0),
+               "empty tree was not a lone root");
+
+        for (int i = 0; i < valno; ++i)
+        {
+                btree_insert(&tree, vals + i, vals + i, cmp_int);
+        }
+        btree_stats(tree, &s);
+
+        size_t nodes = 0;
+        for (size_t i = 0; i < s.height; ++i)
+        {
+                nodes += s.level_nodes[i];
+        }
+        should(eq(s.level_nodes[0], 1), "tree had more than one root");
+        should(eq(nodes, s.nodes), "levels did not add up to the nodes");
+        should(eq(s.entries, valno), "entries were not counted");
+        should(s.height > 1 && ((size_t)1 << (s.height - 1)) <= s.nodes,
+               "height did not match the nodes");
+        should(s.fill > 0 && s.fill <= 1, "fill was not a fraction");
+        should(s.used < s.capacity && s.capacity < s.bytes,
+               "bytes used were not within the bytes allocated");
+        // Every split but the ones of the root adds a single node.
+        should(s.splits >= s.nodes - s.height && s.splits < s.nodes,
+               "splits did not match the nodes");
+        should(eq(s.merges, 0), "inserts merged nodes");
+
+        for (int i = 0; i < valno; ++i)
+        {
+                btree_remove(&tree, vals + i, cmp_int);
+        }
+        btree_stats(tree, &s);
+        should(eq(s.nodes, 1) && eq(s.entries, 0), "tree was not emptied");
+        should(s.merges > 0, "merges were not counted");
+        should(s.splits > 0, "splits were lost by merges");
+
+        btree_destroy(tree);
+
+        return 0;
+}
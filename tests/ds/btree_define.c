@@ -0,0 +1,176 @@
+#include "../tests.h"
+
+#include <ds/btree_define.h>
+
+BTREE_DEFINE(itree, int, int, (a > b) - (a < b))
+BTREE_DEFINE_T(itree2, int, int, (a > b) - (a < b), 2)
+
+struct point
+{
+        int x;
+        int y;
+};
+
+BTREE_DEFINE(ptree, struct point, double,
+             a.x != b.x ? (a.x > b.x) - (a.x < b.x)
+                        : (a.y > b.y) - (a.y < b.y))
+
+int
+main()
+{
+        start();
+
+        test(create);
+        test(search);
+        test(remove_random);
+        test(struct_keys);
+        test(min_degree);
+
+        end();
+}
+
+int
+create()
+{
+        struct itree* tree = itree_create();
+        should(eq(itree_search(tree, 0), NULL), "empty tree had a key");
+        should(!itree_remove(&tree, 0), "empty tree removed a key");
+
+        itree_destroy(tree);
+
+        return 0;
+}
+
+int vals[]
+    = { 44, 19, 13, 39, 94, 7,  36, 75, 77, 24, 52, 49, 28, 79, 88, 26, 59,
+        12, 35, 33, 67, 78, 96, 71, 14, 41, 5,  53, 83, 66, 34, 60, 45, 40,
+        98, 92, 27, 99, 69, 65, 74, 54, 1,  89, 61, 76, 57, 84, 80, 97, 46,
+        64, 32, 29, 81, 87, 68, 42, 91, 93, 9,  2,  23, 37, 48, 58, 50, 73,
+        43, 86, 72, 18, 56, 0,  38, 70, 85, 22, 63, 82, 47, 30, 55, 62, 90,
+        16, 3,  31, 25, 21, 20, 17, 8,  51, 95, 15, 10, 4,  6,  11 };
+int valno = sizeof(vals) / sizeof(int);
+
+int
+search()
+{
+        struct itree* tree = itree_create();
+
+        for (int i = 0; i < valno; ++i)
+        {
+                itree_insert(&tree, vals[i], vals[i] * 2);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int* val = itree_search(tree, i);
+                should(val != NULL, "inserted key was not found");
+                should(eq(*val, i * 2), "value did not match key");
+        }
+        should(eq(itree_search(tree, valno), NULL), "missing key was found");
+
+        for (int i = 0; i < valno; i += 2)
+        {
+                should(itree_remove(&tree, i), "inserted key was not removed");
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int* val = itree_search(tree, i);
+                should(eq(val != NULL, i % 2), "removed key was found");
+        }
+
+        itree_destroy(tree);
+
+        return 0;
+}
+
+int
+remove_random()
+{
+        struct itree* tree = itree_create();
+
+        for (int i = 0; i < valno; ++i)
+        {
+                itree_insert(&tree, i, i);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                should(itree_remove(&tree, vals[i]),
+                       "inserted key was not removed");
+                should(!itree_remove(&tree, vals[i]),
+                       "removed key was removed again");
+        }
+
+        should(eq(tree->n, 0), "tree was not empty");
+
+        itree_destroy(tree);
+
+        return 0;
+}
+
+int
+struct_keys()
+{
+        struct ptree* tree = ptree_create();
+
+        for (int i = 0; i < valno; ++i)
+        {
+                struct point p = { vals[i] % 10, vals[i] / 10 };
+                ptree_insert(&tree, p, vals[i]);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                struct point p = { i % 10, i / 10 };
+                double* val = ptree_search(tree, p);
+                should(val != NULL, "inserted key was not found");
+                should(eq(*val, i), "value did not match key");
+        }
+
+        struct point missing = { 10, 0 };
+        should(eq(ptree_search(tree, missing), NULL), "missing key was found");
+
+        ptree_destroy(tree);
+
+        return 0;
+}
+
+int
+min_degree()
+{
+        // Degree 2 splits and merges on almost every operation.
+        struct itree2* tree = itree2_create();
+        bool present[100] = { false };
+
+        srand(0);
+        for (int i = 0; i < 10000; ++i)
+        {
+                int key = rand() % 100;
+                if (rand() % 2)
+                {
+                        if (!present[key])
+                        {
+                                itree2_insert(&tree, key, key);
+                        }
+                        present[key] = true;
+                }
+                else
+                {
+                        should(eq(itree2_remove(&tree, key), present[key]),
+                               "remove did not match the inserted keys");
+                        present[key] = false;
+                }
+        }
+
+        for (int i = 0; i < 100; ++i)
+        {
+                int* val = itree2_search(tree, i);
+                should(eq(val != NULL, present[i]),
+                       "search did not match the inserted keys");
+        }
+
+        itree2_destroy(tree);
+
+        return 0;
+}
@@ -0,0 +1,113 @@
+#include "../tests.h"
+
+#include <ds/btree_file.h>
+
+int
+main()
+{
+        start();
+
+        test(write_open);
+        test(search);
+        test(empty);
+        test(invalid);
+
+        end();
+}
+
+#define PATH "btree_file.test"
+
+int
+cmp_int(void* a, void* b)
+{
+        return *(int*)a - *(int*)b;
+}
+
+int
+write_open()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < 1000; ++i)
+        {
+                btree_insert(&tree, &i, &i, cmp_int);
+        }
+
+        should(btree_file_write(tree, PATH), "tree was not written");
+        btree_destroy(tree);
+
+        struct btree_file* f = btree_file_open(PATH);
+        should(f != NULL, "file was not opened");
+        should(eq(f->_header->key_size, sizeof(int))
+                   && eq(f->_header->val_size, sizeof(int)),
+               "sizes were not stored");
+
+        btree_file_close(f);
+        remove(PATH);
+
+        return 0;
+}
+
+int
+search()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        for (int i = 0; i < 1000; i += 2)
+        {
+                int value = -i;
+                btree_insert(&tree, &i, &value, cmp_int);
+        }
+        btree_file_write(tree, PATH);
+
+        struct btree_file* f = btree_file_open(PATH);
+        for (int i = 0; i < 1000; ++i)
+        {
+                int* val = btree_file_search(f, &i, cmp_int);
+                should(eq(val != NULL, i % 2 == 0),
+                       "search did not match the tree");
+                should(val == NULL || eq(*val, -i), "value did not match key");
+                int* mem = btree_search(tree, &i, cmp_int);
+                should(eq(val != NULL, mem != NULL),
+                       "search did not match the tree");
+        }
+
+        btree_file_close(f);
+        btree_destroy(tree);
+        remove(PATH);
+
+        return 0;
+}
+
+int
+empty()
+{
+        struct btree* tree = btree_create(sizeof(int), sizeof(int));
+        btree_file_write(tree, PATH);
+        btree_destroy(tree);
+
+        struct btree_file* f = btree_file_open(PATH);
+        int key = 0;
+        should(f != NULL, "empty tree was not opened");
+        should(btree_file_search(f, &key, cmp_int) == NULL,
+               "empty tree had a key");
+
+        btree_file_close(f);
+        remove(PATH);
+
+        return 0;
+}
+
+int
+invalid()
+{
+        should(btree_file_open(PATH) == NULL, "missing file was opened");
+
+        FILE* out = fopen(PATH, "wb");
+        fputs("not a btree, but long enough to hold a header", out);
+        fputs("not a btree, but long enough to hold a header", out);
+        fclose(out);
+        should(btree_file_open(PATH) == NULL, "invalid file was opened");
+
+        remove(PATH);
+
+        return 0;
+}
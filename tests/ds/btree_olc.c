@@ -0,0 +1,315 @@
+#include "../tests.h"
+
+#include <ds/btree_olc.h>
+#include <pthread.h>
+
+int
+main()
+{
+        start();
+
+        test(create);
+        test(insert_delete_random);
+        test(search);
+        test(replace);
+        test(large_entries);
+        test(concurrent_insert);
+        test(concurrent_mixed);
+
+        end();
+}
+
+int
+create()
+{
+        struct btree_olc* tree = btree_olc_create(sizeof(char), sizeof(int));
+
+        should(eq((size_t)tree->_root % _BTREE_OLC_CACHE_LINE, 0),
+               "node was not aligned to a cache line");
+        should(tree->_leaf_max >= 3 && tree->_inner_max >= 3,
+               "nodes held less than 3 keys");
+
+        btree_olc_destroy(tree);
+
+        return 0;
+}
+
+int
+cmp_int(void* a, void* b)
+{
+        return *(int*)a - *(int*)b;
+}
+
+int vals[]
+    = { 44, 19, 13, 39, 94, 7,  36, 75, 77, 24, 52, 49, 28, 79, 88, 26, 59,
+        12, 35, 33, 67, 78, 96, 71, 14, 41, 5,  53, 83, 66, 34, 60, 45, 40,
+        98, 92, 27, 99, 69, 65, 74, 54, 1,  89, 61, 76, 57, 84, 80, 97, 46,
+        64, 32, 29, 81, 87, 68, 42, 91, 93, 9,  2,  23, 37, 48, 58, 50, 73,
+        43, 86, 72, 18, 56, 0,  38, 70, 85, 22, 63, 82, 47, 30, 55, 62, 90,
+        16, 3,  31, 25, 21, 20, 17, 8,  51, 95, 15, 10, 4,  6,  11 };
+int valno = sizeof(vals) / sizeof(int);
+
+int
+insert_delete_random()
+{
+        struct btree_olc* tree = btree_olc_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; ++i)
+        {
+                btree_olc_insert(tree, &i, &i, cmp_int);
+        }
+        should(!tree->_root->leaf, "root was not split");
+
+        for (int i = 0; i < valno; ++i)
+        {
+                should(btree_olc_remove(tree, vals + i, cmp_int),
+                       "inserted key was not removed");
+        }
+        should(!btree_olc_remove(tree, vals, cmp_int),
+               "removed key was removed again");
+
+        btree_olc_destroy(tree);
+
+        return 0;
+}
+
+int
+search()
+{
+        struct btree_olc* tree = btree_olc_create(sizeof(int), sizeof(int));
+        int val;
+
+        for (int i = 0; i < valno; ++i)
+        {
+                btree_olc_insert(tree, vals + i, vals + i, cmp_int);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                should(btree_olc_search(tree, &i, &val, cmp_int),
+                       "inserted key was not found");
+                should(eq(val, i), "value did not match key");
+        }
+
+        for (int i = 0; i < valno; i += 2)
+        {
+                should(btree_olc_remove(tree, &i, cmp_int),
+                       "inserted key was not removed");
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                should(eq(btree_olc_search(tree, &i, &val, cmp_int), i % 2),
+                       "removed key was found");
+        }
+
+        btree_olc_destroy(tree);
+
+        return 0;
+}
+
+int
+replace()
+{
+        struct btree_olc* tree = btree_olc_create(sizeof(int), sizeof(int));
+        int val;
+
+        for (int i = 0; i < valno; ++i)
+        {
+                btree_olc_insert(tree, vals + i, vals + i, cmp_int);
+        }
+        for (int i = 0; i < valno; ++i)
+        {
+                int value = -i;
+                btree_olc_insert(tree, &i, &value, cmp_int);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                btree_olc_search(tree, &i, &val, cmp_int);
+                should(eq(val, -i), "value was not replaced");
+        }
+
+        btree_olc_destroy(tree);
+
+        return 0;
+}
+
+// Entries larger than a node's lines, so nodes hold the minimum of 3 keys.
+struct large
+{
+        int key;
+        char pad[96];
+};
+
+int
+cmp_large(void* a, void* b)
+{
+        return ((struct large*)a)->key - ((struct large*)b)->key;
+}
+
+int
+large_entries()
+{
+        struct btree_olc* tree
+            = btree_olc_create(sizeof(struct large), sizeof(struct large));
+        struct large key, val;
+
+        should(eq(tree->_leaf_max, 3) && eq(tree->_inner_max, 3),
+               "large entries were not clamped to 3 keys");
+
+        for (int i = 0; i < valno; ++i)
+        {
+                memset(&key, vals[i], sizeof(key));
+                key.key = vals[i];
+                btree_olc_insert(tree, &key, &key, cmp_large);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                key.key = i;
+                should(btree_olc_search(tree, &key, &val, cmp_large),
+                       "inserted key was not found");
+                should(eq(val.key, i) && eq(val.pad[95], (char)i),
+                       "value did not match key");
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                key.key = vals[i];
+                should(btree_olc_remove(tree, &key, cmp_large),
+                       "inserted key was not removed");
+        }
+
+        btree_olc_destroy(tree);
+
+        return 0;
+}
+
+#define THREADS 4
+#define KEYS 20000
+
+struct worker
+{
+        struct btree_olc* tree;
+        int id;
+        int errors;
+};
+
+// Interleaves the keys of every thread, so they all split the same nodes.
+void*
+insert_keys(void* arg)
+{
+        struct worker* w = arg;
+        int val;
+
+        for (int i = 0; i < KEYS; ++i)
+        {
+                int key = i * THREADS + w->id;
+                btree_olc_insert(w->tree, &key, &key, cmp_int);
+                if (!btree_olc_search(w->tree, &key, &val, cmp_int)
+                    || val != key)
+                {
+                        ++w->errors;
+                }
+        }
+
+        return NULL;
+}
+
+int
+concurrent_insert()
+{
+        struct btree_olc* tree = btree_olc_create(sizeof(int), sizeof(int));
+        struct worker workers[THREADS];
+        pthread_t threads[THREADS];
+        int val;
+
+        for (int i = 0; i < THREADS; ++i)
+        {
+                workers[i] = (struct worker){ tree, i, 0 };
+                pthread_create(threads + i, NULL, insert_keys, workers + i);
+        }
+        for (int i = 0; i < THREADS; ++i)
+        {
+                pthread_join(threads[i], NULL);
+                should(eq(workers[i].errors, 0),
+                       "key was not found right after inserting it");
+        }
+
+        for (int i = 0; i < KEYS * THREADS; ++i)
+        {
+                should(btree_olc_search(tree, &i, &val, cmp_int),
+                       "inserted key was lost");
+                should(eq(val, i), "value did not match key");
+        }
+
+        btree_olc_destroy(tree);
+
+        return 0;
+}
+
+// Removes its even keys while other threads insert and search theirs.
+void*
+mixed_keys(void* arg)
+{
+        struct worker* w = arg;
+        int val;
+
+        for (int i = 0; i < KEYS; ++i)
+        {
+                int key = i * THREADS + w->id;
+                if (i % 2 == 0
+                    && !btree_olc_remove(w->tree, &key, cmp_int))
+                {
+                        ++w->errors;
+                }
+                if (!btree_olc_search(w->tree, &key, &val, cmp_int)
+                    != (i % 2 == 0))
+                {
+                        ++w->errors;
+                }
+
+                key += KEYS * THREADS;
+                btree_olc_insert(w->tree, &key, &key, cmp_int);
+        }
+
+        return NULL;
+}
+
+int
+concurrent_mixed()
+{
+        struct btree_olc* tree = btree_olc_create(sizeof(int), sizeof(int));
+        struct worker workers[THREADS];
+        pthread_t threads[THREADS];
+        int val;
+
+        for (int i = 0; i < KEYS * THREADS; ++i)
+        {
+                btree_olc_insert(tree, &i, &i, cmp_int);
+        }
+
+        for (int i = 0; i < THREADS; ++i)
+        {
+                workers[i] = (struct worker){ tree, i, 0 };
+                pthread_create(threads + i, NULL, mixed_keys, workers + i);
+        }
+        for (int i = 0; i < THREADS; ++i)
+        {
+                pthread_join(threads[i], NULL);
+                should(eq(workers[i].errors, 0),
+                       "operation did not see its own changes");
+        }
+
+        for (int i = 0; i < 2 * KEYS * THREADS; ++i)
+        {
+                bool removed = i < KEYS * THREADS && (i / THREADS) % 2 == 0;
+                should(eq(btree_olc_search(tree, &i, &val, cmp_int), !removed),
+                       "search did not match the changes");
+        }
+
+        btree_olc_destroy(tree);
+
+        return 0;
+}
@@ -0,0 +1,198 @@
+#include "../tests.h"
+
+#include <ds/cbtree.h>
+
+int
+main()
+{
+        start();
+
+        test(create);
+        test(insert_delete);
+        test(insert_delete_random);
+        test(insert_random_delete);
+        test(search);
+        test(search_mixed_sizes);
+        test(layout);
+
+        end();
+}
+
+int
+create()
+{
+        size_t key_size = sizeof(char);
+        size_t value_size = sizeof(int);
+        struct cbtree* tree = cbtree_create(key_size, value_size);
+
+        cbtree_destroy(tree);
+
+        return 0;
+}
+
+int
+cmp_int(void* a, void* b)
+{
+        return *(int*)a - *(int*)b;
+}
+
+int vals[]
+    = { 44, 19, 13, 39, 94, 7,  36, 75, 77, 24, 52, 49, 28, 79, 88, 26, 59,
+        12, 35, 33, 67, 78, 96, 71, 14, 41, 5,  53, 83, 66, 34, 60, 45, 40,
+        98, 92, 27, 99, 69, 65, 74, 54, 1,  89, 61, 76, 57, 84, 80, 97, 46,
+        64, 32, 29, 81, 87, 68, 42, 91, 93, 9,  2,  23, 37, 48, 58, 50, 73,
+        43, 86, 72, 18, 56, 0,  38, 70, 85, 22, 63, 82, 47, 30, 55, 62, 90,
+        16, 3,  31, 25, 21, 20, 17, 8,  51, 95, 15, 10, 4,  6,  11 };
+int valno = sizeof(vals) / sizeof(int);
+
+int
+insert_delete()
+{
+        struct cbtree* tree = cbtree_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; ++i)
+        {
+                cbtree_insert(&tree, &i, &i, cmp_int);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                cbtree_remove(&tree, &i, cmp_int);
+        }
+
+        cbtree_destroy(tree);
+
+        return 0;
+}
+
+int
+insert_delete_random()
+{
+        struct cbtree* tree = cbtree_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; ++i)
+        {
+                cbtree_insert(&tree, &i, &i, cmp_int);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                cbtree_remove(&tree, vals + i, cmp_int);
+        }
+
+        cbtree_destroy(tree);
+
+        return 0;
+}
+
+int
+insert_random_delete()
+{
+        struct cbtree* tree = cbtree_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; ++i)
+        {
+                cbtree_insert(&tree, vals + i, vals + i, cmp_int);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                cbtree_remove(&tree, &i, cmp_int);
+        }
+
+        cbtree_destroy(tree);
+
+        return 0;
+}
+
+int
+search()
+{
+        struct cbtree* tree = cbtree_create(sizeof(int), sizeof(int));
+
+        for (int i = 0; i < valno; ++i)
+        {
+                cbtree_insert(&tree, vals + i, vals + i, cmp_int);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int* val = cbtree_search(tree, &i, cmp_int);
+                should(val != NULL, "inserted key was not found");
+                should(eq(*val, i), "value did not match key");
+        }
+
+        for (int i = 0; i < valno; i += 2)
+        {
+                should(cbtree_remove(&tree, &i, cmp_int),
+                       "inserted key was not removed");
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                int* val = cbtree_search(tree, &i, cmp_int);
+                should(eq(val != NULL, i % 2), "removed key was found");
+        }
+
+        cbtree_destroy(tree);
+
+        return 0;
+}
+
+int
+cmp_char(void* a, void* b)
+{
+        return *(char*)a - *(char*)b;
+}
+
+int
+search_mixed_sizes()
+{
+        // Keys smaller than the values, so the values need padding to be
+        // aligned.
+        struct cbtree* tree = cbtree_create(sizeof(char), sizeof(long));
+
+        should(eq(tree->_values % sizeof(long), 0),
+               "values were not aligned");
+        should(tree->_children + 2 * tree->_t * sizeof(struct cbtree*)
+                   <= _CBTREE_LINES * _CBTREE_CACHE_LINE,
+               "padded internal node did not fit in its cache lines");
+
+        for (int i = 0; i < valno; ++i)
+        {
+                char key = vals[i];
+                long value = -(long)vals[i];
+                cbtree_insert(&tree, &key, &value, cmp_char);
+        }
+
+        for (int i = 0; i < valno; ++i)
+        {
+                char key = i;
+                long* val = cbtree_search(tree, &key, cmp_char);
+                should(val != NULL, "inserted key was not found");
+                should(eq((size_t)val % sizeof(long), 0),
+                       "value was not aligned");
+                should(eq(*val, -(long)i), "value did not match key");
+        }
+
+        cbtree_destroy(tree);
+
+        return 0;
+}
+
+int
+layout()
+{
+        struct cbtree* tree = cbtree_create(sizeof(int), sizeof(int));
+
+        should(eq((size_t)tree % _CBTREE_CACHE_LINE, 0),
+               "node was not aligned to a cache line");
+        should(tree->_t >= 2, "degree was smaller than 2");
+        should(tree->_children + 2 * tree->_t * sizeof(struct cbtree*)
+                   <= _CBTREE_LINES * _CBTREE_CACHE_LINE,
+               "internal node did not fit in its cache lines");
+
+        cbtree_destroy(tree);
+
+        return 0;
+}
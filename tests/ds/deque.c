@@ -0,0 +1,182 @@
+#include "../tests.h"
+
+#include <ds/deque.h>
+
+int
+main()
+{
+        start();
+
+        test(create);
+        test(fifo);
+        test(lifo);
+        test(push_front);
+        test(wrap_grow);
+        test(segments);
+        test(growth_policy);
+
+        end();
+}
+
+int
+create()
+{
+        struct deque* d = deque_create(sizeof(int), 0);
+        int el;
+
+        should(deque_empty(d), "new deque was not empty");
+        should(eq(deque_len(d), 0), "new deque had elements");
+        should(!deque_pop_front(d, &el), "empty deque popped at the front");
+        should(!deque_pop_back(d, &el), "empty deque popped at the back");
+
+        deque_destroy(d);
+        return 0;
+}
+
+int
+fifo()
+{
+        struct deque* d = deque_create(sizeof(int), 4);
+        int el;
+
+        // Keeps a few elements queued while many pass through, so the head
+        // goes around the ring many times.
+        for (int i = 0; i < 3; ++i)
+                deque_push_back(d, &i);
+        for (int i = 3; i < 1000; ++i)
+        {
+                deque_push_back(d, &i);
+                should(deque_pop_front(d, &el) && eq(el, i - 3),
+                       "elements did not come out in order");
+        }
+        should(eq(deque_len(d), 3), "len was not kept");
+        should(eq(((struct _slice*)d->_slots)->capacity, 4 * sizeof(int)),
+               "deque grew without being full");
+
+        deque_destroy(d);
+        return 0;
+}
+
+int
+lifo()
+{
+        struct deque* d = deque_create(sizeof(int), 1);
+        int el;
+
+        for (int i = 0; i < 100; ++i)
+                deque_push_back(d, &i);
+        for (int i = 99; i >= 0; --i)
+        {
+                should(eq(*(int*)deque_back(d), i), "back did not match");
+                should(deque_pop_back(d, &el) && eq(el, i),
+                       "elements did not come out in reverse");
+        }
+        should(deque_empty(d), "popped deque was not empty");
+
+        deque_destroy(d);
+        return 0;
+}
+
+int
+push_front()
+{
+        struct deque* d = deque_create(sizeof(int), 2);
+
+        // Builds -99..99 from the middle out.
+        for (int i = 0; i < 100; ++i)
+        {
+                int neg = -i - 1;
+                int pos = i;
+                deque_push_front(d, &neg);
+                deque_push_back(d, &pos);
+        }
+
+        should(eq(deque_len(d), 200), "len was not updated");
+        should(eq(*(int*)deque_front(d), -100), "front did not match");
+        for (int i = 0; i < 200; ++i)
+                should(eq(*(int*)deque_at(d, i), i - 100),
+                       "elements were not in order");
+
+        deque_destroy(d);
+        return 0;
+}
+
+int
+wrap_grow()
+{
+        struct deque* d = deque_create(sizeof(int), 8);
+        int el;
+
+        // Moves the head to the middle of the ring, then fills it so it
+        // grows while wrapped.
+        for (int i = 0; i < 5; ++i)
+                deque_push_back(d, &i);
+        for (int i = 0; i < 5; ++i)
+                deque_pop_front(d, NULL);
+        for (int i = 0; i < 20; ++i)
+                deque_push_back(d, &i);
+
+        for (int i = 0; i < 20; ++i)
+                should(deque_pop_front(d, &el) && eq(el, i),
+                       "wrapped elements were lost when growing");
+
+        deque_destroy(d);
+        return 0;
+}
+
+int
+segments()
+{
+        struct deque* d = deque_create(sizeof(int), 8);
+        struct slice first, second;
+
+        deque_segments(d, &first, &second);
+        should(eq(first.len, 0) && eq(second.len, 0),
+               "empty deque had segments");
+
+        for (int i = 0; i < 6; ++i)
+                deque_push_back(d, &i);
+        deque_segments(d, &first, &second);
+        should(eq(first.len, 6) && eq(second.len, 0),
+               "unwrapped deque had two segments");
+
+        for (int i = 0; i < 4; ++i)
+                deque_pop_front(d, NULL);
+        for (int i = 6; i < 10; ++i)
+                deque_push_back(d, &i);
+        deque_segments(d, &first, &second);
+        should(eq(first.len + second.len, 6), "segments missed elements");
+        should(eq(second.len, 2), "wrapped deque had one segment");
+
+        int expected = 4;
+        for (size_t i = 0; i < first.len; ++i)
+                should(eq(((int*)first.data)[i], expected++),
+                       "first segment was out of order");
+        for (size_t i = 0; i < second.len; ++i)
+                should(eq(((int*)second.data)[i], expected++),
+                       "second segment was out of order");
+
+        deque_destroy(d);
+        return 0;
+}
+
+int
+growth_policy()
+{
+        struct deque* d = deque_create(sizeof(int), 3);
+        slice_set_growth(d->_slots, SLICE_GROW_HALF);
+
+        // A capacity that is not a power of 2, wrapped at every size.
+        for (int i = 0; i < 1000; ++i)
+        {
+                int neg = -i - 1;
+                deque_push_back(d, &i);
+                deque_push_front(d, &neg);
+        }
+        for (int i = 0; i < 2000; ++i)
+                should(eq(*(int*)deque_at(d, i), i - 1000),
+                       "elements were not in order");
+
+        deque_destroy(d);
+        return 0;
+}
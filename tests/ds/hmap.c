@@ -0,0 +1,228 @@
+#include "../tests.h"
+
+#include <ds/hmap.h>
+
+int
+main()
+{
+        start();
+
+        test(create);
+        test(insert_search);
+        test(replace);
+        test(replace_full);
+        test(remove_keys);
+        test(collisions);
+        test(struct_keys);
+
+        end();
+}
+
+int
+create()
+{
+        struct hmap* m = hmap_create(sizeof(int), sizeof(int), NULL, NULL);
+
+        should(eq(hmap_len(m), 0), "new map was not empty");
+        int key = 0;
+        should(hmap_search(m, &key) == NULL, "empty map had a key");
+
+        hmap_destroy(m);
+
+        return 0;
+}
+
+int
+insert_search()
+{
+        struct hmap* m
+            = hmap_create(sizeof(int), sizeof(int), hmap_hash_int, NULL);
+
+        // Enough keys to grow the map a few times.
+        for (int i = 0; i < 1000; ++i)
+        {
+                int value = -i;
+                hmap_insert(m, &i, &value);
+        }
+        should(eq(hmap_len(m), 1000), "entries were not counted");
+
+        for (int i = 0; i < 2000; ++i)
+        {
+                int* val = hmap_search(m, &i);
+                should(eq(val != NULL, i < 1000),
+                       "search did not match the inserted keys");
+                should(val == NULL || eq(*val, -i), "value did not match key");
+        }
+
+        hmap_destroy(m);
+
+        return 0;
+}
+
+int
+replace()
+{
+        struct hmap* m = hmap_create(sizeof(int), sizeof(int), NULL, NULL);
+
+        for (int i = 0; i < 100; ++i)
+        {
+                hmap_insert(m, &i, &i);
+        }
+        for (int i = 0; i < 100; ++i)
+        {
+                int value = 2 * i;
+                hmap_insert(m, &i, &value);
+        }
+        should(eq(hmap_len(m), 100), "replaced keys were counted again");
+
+        for (int i = 0; i < 100; ++i)
+        {
+                should(eq(*(int*)hmap_search(m, &i), 2 * i),
+                       "value was not replaced");
+        }
+
+        hmap_destroy(m);
+
+        return 0;
+}
+
+int
+replace_full()
+{
+        struct hmap* m = hmap_create(sizeof(int), sizeof(int), NULL, NULL);
+        int keyno = _HMAP_MIN_SLOTS * _HMAP_MAX_LOAD / 8;
+
+        // Fills the map up to its load, so any new key would grow it.
+        for (int i = 0; i < keyno; ++i)
+        {
+                hmap_insert(m, &i, &i);
+        }
+        for (int i = 0; i < keyno; ++i)
+        {
+                int value = -i;
+                hmap_insert(m, &i, &value);
+        }
+        should(eq(m->_slots->len, _HMAP_MIN_SLOTS),
+               "replacing values grew the map");
+
+        for (int i = 0; i < keyno; ++i)
+        {
+                should(eq(*(int*)hmap_search(m, &i), -i),
+                       "value was not replaced");
+        }
+
+        hmap_destroy(m);
+
+        return 0;
+}
+
+int
+remove_keys()
+{
+        struct hmap* m = hmap_create(sizeof(int), sizeof(int), NULL, NULL);
+
+        for (int i = 0; i < 1000; ++i)
+        {
+                hmap_insert(m, &i, &i);
+        }
+        for (int i = 0; i < 1000; i += 2)
+        {
+                should(hmap_remove(m, &i), "inserted key was not removed");
+        }
+        should(!hmap_remove(m, &(int){ 0 }), "removed key was removed again");
+        should(eq(hmap_len(m), 500), "removed entries were counted");
+
+        // Entries shifted back by removals are still found.
+        for (int i = 0; i < 1000; ++i)
+        {
+                int* val = hmap_search(m, &i);
+                should(eq(val != NULL, i % 2), "removed key was found");
+                should(val == NULL || eq(*val, i), "value did not match key");
+        }
+
+        hmap_destroy(m);
+
+        return 0;
+}
+
+size_t
+hash_mod(data* key, size_t key_size)
+{
+        // Sends every key to one of 4 slots.
+        return *(int*)key % 4;
+}
+
+int
+collisions()
+{
+        struct hmap* m = hmap_create(sizeof(int), sizeof(int), hash_mod, NULL);
+        bool present[200] = { false };
+
+        srand(0);
+        for (int i = 0; i < 10000; ++i)
+        {
+                int key = rand() % 200;
+                if (rand() % 2)
+                {
+                        hmap_insert(m, &key, &key);
+                        present[key] = true;
+                }
+                else
+                {
+                        should(eq(hmap_remove(m, &key), present[key]),
+                               "remove did not match the inserted keys");
+                        present[key] = false;
+                }
+        }
+
+        for (int i = 0; i < 200; ++i)
+        {
+                int* val = hmap_search(m, &i);
+                should(eq(val != NULL, present[i]),
+                       "search did not match the inserted keys");
+        }
+
+        hmap_destroy(m);
+
+        return 0;
+}
+
+struct point
+{
+        int x;
+        int y;
+};
+
+int
+cmp_point(void* a, void* b)
+{
+        struct point* p = a;
+        struct point* q = b;
+        return p->x != q->x || p->y != q->y;
+}
+
+int
+struct_keys()
+{
+        struct hmap* m
+            = hmap_create(sizeof(struct point), sizeof(int), NULL, cmp_point);
+
+        for (int i = 0; i < 100; ++i)
+        {
+                struct point p = { i, -i };
+                hmap_insert(m, &p, &i);
+        }
+
+        for (int i = 0; i < 100; ++i)
+        {
+                struct point p = { i, -i };
+                struct point q = { i, i + 1 };
+                int* val = hmap_search(m, &p);
+                should(val != NULL && eq(*val, i), "struct key was not found");
+                should(hmap_search(m, &q) == NULL, "missing key was found");
+        }
+
+        hmap_destroy(m);
+
+        return 0;
+}
@@ -8,6 +8,7 @@ main()
         start();
 
         test(make);
+        test(make_aligned);
         test(set);
         test(at);
 
@@ -33,6 +34,23 @@ make()
         return 0;
 }
 
+int
+make_aligned()
+{
+        struct mat m = { 0 };
+
+        mat_make_aligned(&m, sizeof(float), 3, 5, 64);
+
+        should(eq((size_t)m._data % 64, 0), "data was not aligned");
+        should(eq(m._ino, 3) && eq(m._jno, 5), "sizes were not initialized");
+        float el = 1.5f;
+        mat_set(&m, 2, 4, &el);
+        should(eq(*(float*)mat_at(&m, 2, 4), el), "aligned data was not set");
+
+        mat_del(&m);
+        return 0;
+}
+
 int
 idxof()
 {
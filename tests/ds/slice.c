@@ -8,12 +8,23 @@ main()
         start();
 
         test(make);
+        test(make_in);
+        test(make_inline);
+        test(make_aligned);
         test(empty);
         test(resize);
+        test(growth);
+        test(hugepage);
+        test(reserve);
+        test(shrink_to_fit);
         test(append);
         test(sappend);
         test(insert);
         test(sinsert);
+        test(append_n);
+        test(insert_n);
+        test(extend);
+        test(delete_range);
         test(delete_at);
         test(rwd);
         test(clear);
@@ -40,6 +51,94 @@ make()
         return 0;
 }
 
+int
+make_in()
+{
+        size_t mem[16];
+        struct slice* s = slice_make_in(mem, sizeof(mem), sizeof(int));
+        struct _slice* h = (struct _slice*)s;
+        byte* start = (byte*)mem;
+        byte* end = start + sizeof(mem);
+
+        should(eq((data*)s, (data*)mem), "slice was not placed on mem");
+        should(h->data > start && h->data < end, "array was not on mem");
+        should(eq(h->capacity, (sizeof(mem) - sizeof(*h)) / sizeof(int)
+                                   * sizeof(int)),
+               "capacity did not fill mem");
+
+        int fit = h->capacity / sizeof(int);
+        for (int i = 0; i < fit; ++i)
+                slice_sappend(s, &i);
+        should(h->data > start && h->data < end, "array left mem too soon");
+
+        slice_shrink_to_fit(s);
+        should(h->data > start && h->data < end,
+               "shrinking moved the array off mem");
+
+        // Spills to the heap, keeping every element.
+        for (int i = fit; i < 100; ++i)
+                slice_sappend(s, &i);
+        should(h->data < start || h->data >= end, "array did not spill");
+        for (int i = 0; i < 100; ++i)
+                should(eq(*(int*)slice_at(s, i), i),
+                       "elements were lost when spilling");
+
+        slice_release(s);
+        return 0;
+}
+
+int
+make_inline()
+{
+        struct slice* s = slice_make_inline(sizeof(int), 4);
+        struct _slice* h = (struct _slice*)s;
+
+        should(eq(h->data, (byte*)(h + 1)), "array was not inline");
+        should(eq(h->capacity, 4 * sizeof(int)), "capacity was not set");
+
+        for (int i = 0; i < 4; ++i)
+                slice_sappend(s, &i);
+        should(eq(h->data, (byte*)(h + 1)), "array left too soon");
+
+        int el = 4;
+        slice_sappend(s, &el);
+        should(!eq(h->data, (byte*)(h + 1)), "array did not spill");
+        for (int i = 0; i < 5; ++i)
+                should(eq(*(int*)slice_at(s, i), i),
+                       "elements were lost when spilling");
+
+        slice_del(s);
+        return 0;
+}
+
+int
+make_aligned()
+{
+        struct slice* s = slice_make_aligned(sizeof(char), 3, 64);
+        struct _slice* h = (struct _slice*)s;
+
+        should(eq((size_t)h->data % 64, 0), "array was not aligned");
+
+        // Every growth keeps the alignment, whatever realloc returns.
+        for (int i = 0; i < 100000; ++i)
+        {
+                char el = i;
+                slice_sappend(s, &el);
+                should(eq((size_t)h->data % 64, 0),
+                       "array lost its alignment when growing");
+        }
+        for (int i = 0; i < 100000; ++i)
+                should(eq(*(char*)slice_at(s, i), (char)i),
+                       "elements were lost when growing");
+
+        slice_rwd(s, 99990);
+        slice_shrink_to_fit(s);
+        should(eq((size_t)h->data % 64, 0), "shrinking lost the alignment");
+
+        slice_del(s);
+        return 0;
+}
+
 int
 empty()
 {
@@ -75,6 +174,132 @@ resize()
         return 0;
 }
 
+int
+growth()
+{
+        size_t el_size = sizeof(int);
+        struct slice* s = slice_make(el_size, 4);
+        struct _slice* h = (struct _slice*)s;
+
+        slice_set_growth(s, SLICE_GROW_HALF);
+        slice_resize(s);
+        should(eq(h->capacity, 6 * el_size), "capacity did not grow by half");
+
+        slice_set_growth(s, SLICE_GROW_CHUNK);
+        slice_resize(s);
+        should(eq(h->capacity, 6 * el_size + _SLICE_CHUNK_SIZE),
+               "capacity did not grow by a chunk");
+
+        slice_set_growth(s, SLICE_GROW_HUGEPAGE);
+        slice_resize(s);
+        should(eq(h->capacity, 2 * _SLICE_CHUNK_SIZE),
+               "capacity was not rounded to a power of 2");
+
+        // Every policy makes room for at least one element.
+        struct slice* empty = slice_make(el_size, 0);
+        for (int i = 0; i < 100; ++i)
+                slice_sappend(empty, &i);
+        for (int i = 0; i < 100; ++i)
+                should(eq(*(int*)slice_at(empty, i), i),
+                       "empty slice did not grow");
+
+        slice_del(empty);
+        slice_del(s);
+        return 0;
+}
+
+int
+hugepage()
+{
+        struct slice* s = slice_make(sizeof(int), 1);
+        struct _slice* h = (struct _slice*)s;
+        slice_set_growth(s, SLICE_GROW_HUGEPAGE);
+
+        int n = 2 * _SLICE_HUGEPAGE_SIZE / sizeof(int);
+        for (int i = 0; i < n; ++i)
+                slice_sappend(s, &i);
+
+        should(h->mapped, "huge array was not mapped");
+        should(eq((size_t)h->data % _SLICE_HUGEPAGE_SIZE, 0),
+               "huge array was not aligned");
+        should(eq(h->capacity, 2 * _SLICE_HUGEPAGE_SIZE),
+               "capacity was not a power of 2");
+        for (int i = 0; i < n; ++i)
+                should(eq(*(int*)slice_at(s, i), i),
+                       "elements were lost when moving");
+
+        // Stays mapped while huge, and moves to the heap below that.
+        slice_rwd(s, n / 2);
+        slice_shrink_to_fit(s);
+        should(h->mapped && eq(h->capacity, _SLICE_HUGEPAGE_SIZE),
+               "huge array was not kept mapped when shrunk");
+        slice_rwd(s, n / 2 - 10);
+        slice_shrink_to_fit(s);
+        should(!h->mapped && h->owned, "small array was kept mapped");
+        should(eq(h->capacity, 10 * sizeof(int)),
+               "mapped array was not shrunk");
+        for (int i = 0; i < 10; ++i)
+                should(eq(*(int*)slice_at(s, i), i),
+                       "elements were lost when shrinking");
+
+        slice_del(s);
+        return 0;
+}
+
+int
+reserve()
+{
+        size_t el_size = sizeof(int);
+        struct slice* s = slice_make(el_size, 2);
+        struct _slice* h = (struct _slice*)s;
+        int el = 1;
+        slice_append(s, &el);
+
+        slice_reserve(s, 1);
+        should(eq(h->capacity, 2 * el_size), "reserve shrank the slice");
+
+        slice_reserve(s, 100);
+        should(eq(h->capacity, 100 * el_size), "reserve did not grow");
+        should(eq(h->len, 1) && eq(*(int*)slice_at(s, 0), el),
+               "reserve lost the elements");
+
+        byte* data = h->data;
+        for (int i = 1; i < 100; ++i)
+                slice_sappend(s, &i);
+        should(eq(h->data, data), "reserved slice was reallocated");
+
+        slice_del(s);
+        return 0;
+}
+
+int
+shrink_to_fit()
+{
+        size_t el_size = sizeof(int);
+        struct slice* s = slice_make(el_size, 100);
+        struct _slice* h = (struct _slice*)s;
+
+        for (int i = 0; i < 10; ++i)
+                slice_append(s, &i);
+        slice_shrink_to_fit(s);
+        should(eq(h->capacity, 10 * el_size), "slice was not shrunk");
+        for (int i = 0; i < 10; ++i)
+                should(eq(*(int*)slice_at(s, i), i),
+                       "shrinking lost the elements");
+
+        slice_clear(s);
+        slice_shrink_to_fit(s);
+        should(eq(h->capacity, el_size), "cleared slice was not shrunk");
+
+        int el = 42;
+        slice_sappend(s, &el);
+        slice_sappend(s, &el);
+        should(eq(h->len, 2), "shrunk slice did not grow");
+
+        slice_del(s);
+        return 0;
+}
+
 int
 append()
 {
@@ -163,6 +388,103 @@ sinsert()
         return 0;
 }
 
+int
+append_n()
+{
+        int els[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+        struct slice* s = slice_make(sizeof(int), 2);
+        struct _slice* h = (struct _slice*)s;
+
+        slice_append_n(s, els, 3);
+        should(eq(h->len, 3), "len was not updated");
+        should(eq(h->capacity, 2 * sizeof(int) * _SLICE_SCALE_FACTOR),
+               "slice was not grown by its policy");
+
+        // Too many to fit after growing by the policy.
+        slice_append_n(s, els + 3, 7);
+        should(eq(h->len, 10), "len was not updated");
+        should(h->capacity >= 10 * sizeof(int), "slice was not grown to fit");
+        for (int i = 0; i < 10; ++i)
+                should(eq(*(int*)slice_at(s, i), els[i]),
+                       "elements were not appended");
+
+        slice_append_n(s, els, 0);
+        should(eq(h->len, 10), "appending nothing changed the slice");
+
+        slice_del(s);
+        return 0;
+}
+
+int
+insert_n()
+{
+        int els[] = { 0, 1, 2 };
+        int res[] = { 0, 1, 2, 3, 0, 1, 2, 4, 0, 1, 2 };
+        struct slice* s = slice_make(sizeof(int), 1);
+
+        for (int i = 3; i <= 4; ++i)
+                slice_sappend(s, &i);
+        slice_insert_n(s, els, 3, 0);
+        slice_insert_n(s, els, 3, 4);
+        slice_insert_n(s, els, 3, s->len);
+
+        should(eq(s->len, 11), "len was not updated");
+        for (int i = 0; i < 11; ++i)
+                should(eq(*(int*)slice_at(s, i), res[i]),
+                       "element order was incorrect");
+
+        slice_del(s);
+        return 0;
+}
+
+int
+extend()
+{
+        struct slice* a = slice_make(sizeof(int), 4);
+        struct slice* b = slice_make(sizeof(int), 4);
+
+        for (int i = 0; i < 4; ++i)
+        {
+                slice_append(a, &i);
+                int j = i + 4;
+                slice_append(b, &j);
+        }
+        slice_extend(a, b);
+
+        should(eq(a->len, 8), "len was not updated");
+        should(eq(b->len, 4), "source was changed");
+        for (int i = 0; i < 8; ++i)
+                should(eq(*(int*)slice_at(a, i), i), "slice was not extended");
+
+        slice_del(a);
+        slice_del(b);
+        return 0;
+}
+
+int
+delete_range()
+{
+        int res[] = { 0, 1, 5, 6, 7 };
+        struct slice* s = slice_make(sizeof(int), 8);
+
+        for (int i = 0; i < 8; ++i)
+                slice_append(s, &i);
+        slice_delete_range(s, 2, 3);
+
+        should(eq(s->len, 5), "len was not updated");
+        for (int i = 0; i < 5; ++i)
+                should(eq(*(int*)slice_at(s, i), res[i]),
+                       "element order was incorrect");
+
+        slice_delete_range(s, 3, 2);
+        should(eq(s->len, 3), "trailing range was not deleted");
+        slice_delete_range(s, 0, 3);
+        should(slice_empty(s), "whole slice was not deleted");
+
+        slice_del(s);
+        return 0;
+}
+
 int
 delete_at()
 {
@@ -0,0 +1,138 @@
+#include "../tests.h"
+
+#include <ds/slice_define.h>
+
+SLICE_DEFINE(ints, int)
+
+struct point
+{
+        int x;
+        int y;
+};
+
+SLICE_DEFINE(points, struct point)
+
+int
+main()
+{
+        start();
+
+        test(make);
+        test(push);
+        test(insert);
+        test(interop);
+        test(struct_elements);
+
+        end();
+}
+
+int
+make()
+{
+        struct ints* s = ints_make(2);
+        struct _slice* h = (struct _slice*)s;
+
+        should(eq(h->capacity, 2 * sizeof(int)),
+               "capacity was not initialized");
+        should(eq(h->el_size, sizeof(int)), "el_size was not initialized");
+        should(eq(s->len, 0), "len was not initialized");
+        should(!eq(s->data, NULL), "data was not allocated");
+
+        ints_del(s);
+        return 0;
+}
+
+int
+push()
+{
+        struct ints* s = ints_make(1);
+
+        for (int i = 0; i < 100; ++i)
+        {
+                ints_push(s, i);
+        }
+        should(eq(s->len, 100), "len was not incremented");
+        for (int i = 0; i < 100; ++i)
+        {
+                should(eq(*ints_at(s, i), i), "element was not pushed");
+        }
+
+        ints_del(s);
+        return 0;
+}
+
+int
+insert()
+{
+        struct ints* s = ints_make(1);
+
+        // Builds 0..99 by inserting at both ends and in the middle.
+        for (int i = 0; i < 100; i += 4)
+        {
+                ints_push(s, i + 3);
+        }
+        for (int i = 0; i < 25; ++i)
+        {
+                ints_insert(s, 4 * i, 4 * i);
+                ints_insert(s, 4 * i + 1, 4 * i + 1);
+                ints_insert(s, 4 * i + 2, 4 * i + 2);
+        }
+        ints_insert(s, 100, s->len);
+
+        should(eq(s->len, 101), "len was not incremented");
+        for (int i = 0; i <= 100; ++i)
+        {
+                should(eq(*ints_at(s, i), i), "element was not inserted");
+        }
+
+        ints_del(s);
+        return 0;
+}
+
+int
+interop()
+{
+        struct slice* generic = slice_make(sizeof(int), 1);
+        struct ints* s = ints_of(generic);
+
+        for (int i = 0; i < 10; ++i)
+        {
+                slice_sappend(generic, &i);
+                ints_push(s, -i);
+        }
+
+        should(eq(generic->len, 20), "typed push did not update the slice");
+        for (int i = 0; i < 10; ++i)
+        {
+                should(eq(*(int*)slice_at(generic, 2 * i), i)
+                           && eq(*ints_at(s, 2 * i + 1), -i),
+                       "typed and generic elements did not match");
+        }
+
+        slice_delete_at(ints_slice(s), 0);
+        should(eq(*ints_at(s, 0), 0) && eq(s->len, 19),
+               "generic delete did not update the typed slice");
+
+        ints_del(s);
+        return 0;
+}
+
+int
+struct_elements()
+{
+        struct points* s = points_make(1);
+
+        for (int i = 0; i < 10; ++i)
+        {
+                points_push(s, (struct point){ i, -i });
+        }
+        points_insert(s, (struct point){ 42, 42 }, 5);
+
+        should(eq(points_at(s, 5)->x, 42), "element was not inserted");
+        should(eq(points_at(s, 6)->x, 5) && eq(points_at(s, 6)->y, -5),
+               "elements were not shifted");
+        should(eq(points_at(s, 10)->x, 9), "last element was lost");
+
+        points_del(s);
+        return 0;
+}